@@ -0,0 +1,207 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "analysis.h"
+#include "strategy.h"
+#include "rules.h"
+#include "reachability.h"
+#include "planner.h"
+
+static void analyzeObjective(GameState* state, int objectiveIndex, ObjectiveAnalysis* oa) {
+    Objective objective = state->objectives[objectiveIndex];
+    
+    oa->open = isObjectiveOpen(state, objective);
+    oa->pathLength = 0;
+    oa->nbMissing = 0;
+    oa->routesOwned = 0;
+    oa->routesBlocked = 0;
+    oa->blocked = 1;
+    oa->distance = -1;
+    
+    if (!oa->open) {
+        return;
+    }
+    
+    // Incremental: only routes claimed since the last decision are repaired
+    oa->distance = plannerPath(state, &state->planners[objectiveIndex], objective.from, objective.to,
+                               oa->path, &oa->pathLength);
+    if (oa->distance < 0) {
+        oa->pathLength = 0;
+        return;
+    }
+    
+    for (int j = 0; j < oa->pathLength - 1; j++) {
+        int routeIndex = findRouteIndex(state, oa->path[j], oa->path[j + 1]);
+        int owner = (routeIndex >= 0) ? state->routes[routeIndex].owner : -1;
+        
+        if (owner == 1) {
+            oa->routesOwned++;
+        } else if (owner == 0) {
+            oa->missingRoutes[oa->nbMissing++] = routeIndex;
+        } else {
+            oa->routesBlocked++;
+        }
+    }
+    
+    oa->blocked = (oa->distance == 0) ||
+                  (oa->nbMissing == 0 && oa->routesOwned < oa->pathLength - 1);
+}
+
+static void indexAddRoute(RouteObjectiveIndex* index, int routeIndex, int score) {
+    if (index->routeObjectives[routeIndex]++ == 0) {
+        index->candidates[index->nbCandidates++] = routeIndex;
+        index->candidatePos[routeIndex] = index->nbCandidates;
+    }
+    index->routeValue[routeIndex] += score;
+}
+
+static void indexRemoveRoute(RouteObjectiveIndex* index, int routeIndex, int score) {
+    index->routeValue[routeIndex] -= score;
+    if (--index->routeObjectives[routeIndex] == 0) {
+        int pos = index->candidatePos[routeIndex] - 1;
+        int last = index->candidates[--index->nbCandidates];
+        index->candidates[pos] = last;
+        index->candidatePos[last] = pos + 1;
+        index->candidatePos[routeIndex] = 0;
+    }
+}
+
+// Free routes along an unblocked objective's path; parallel routes all count
+static int buildPlan(GameState* state, ObjectiveAnalysis* oa, int* plan) {
+    int count = 0;
+    
+    if (!oa->open || oa->blocked) {
+        return 0;
+    }
+    
+    for (int p = 0; p < oa->pathLength - 1; p++) {
+        int a = oa->path[p];
+        int b = oa->path[p + 1];
+        
+        for (int r = 0; r < state->nbTracks && count < MAX_CITIES * 2; r++) {
+            if (state->routes[r].owner == 0 &&
+                ((state->routes[r].from == a && state->routes[r].to == b) ||
+                 (state->routes[r].from == b && state->routes[r].to == a))) {
+                plan[count++] = r;
+            }
+        }
+    }
+    
+    return count;
+}
+
+// Only objectives whose plan differs from the indexed one are patched
+static void updateRouteObjectiveIndex(GameState* state, TurnAnalysis* analysis) {
+    RouteObjectiveIndex* index = &analysis->routeIndex;
+    int slots = state->nbObjectives > index->nbPlans ? state->nbObjectives : index->nbPlans;
+    
+    for (int i = 0; i < slots; i++) {
+        int plan[MAX_CITIES * 2];
+        int count = 0;
+        int score = 0;
+        
+        if (i < state->nbObjectives) {
+            count = buildPlan(state, &analysis->objectives[i], plan);
+            score = state->objectives[i].score;
+        }
+        
+        if (i < index->nbPlans && count == index->nbPlanRoutes[i] && score == index->planScore[i] &&
+            memcmp(plan, index->planRoutes[i], sizeof(int) * count) == 0) {
+            continue;
+        }
+        
+        if (i < index->nbPlans) {
+            for (int k = 0; k < index->nbPlanRoutes[i]; k++) {
+                indexRemoveRoute(index, index->planRoutes[i][k], index->planScore[i]);
+            }
+        }
+        
+        for (int k = 0; k < count; k++) {
+            indexAddRoute(index, plan[k], score);
+        }
+        memcpy(index->planRoutes[i], plan, sizeof(int) * count);
+        index->nbPlanRoutes[i] = count;
+        index->planScore[i] = score;
+    }
+    
+    index->nbPlans = state->nbObjectives;
+}
+
+void computeTurnAnalysis(GameState* state, TurnAnalysis* analysis) {
+    if (!state || !analysis) {
+        return;
+    }
+    
+    analysis->totalCards = 0;
+    for (int c = PURPLE; c <= LOCOMOTIVE; c++) {
+        analysis->totalCards += state->nbCardsByColor[c];
+    }
+    
+    for (int i = 0; i < state->nbObjectives; i++) {
+        analyzeObjective(state, i, &analysis->objectives[i]);
+    }
+    
+    // Routes we can claim right now, with the colour we would pay
+    analysis->nbClaimable = 0;
+    for (int i = 0; i < state->nbTracks; i++) {
+        MoveData move;
+        analysis->claimable[i] = 0;
+        
+        if (state->routes[i].owner == 0 && canTakeRouteIndex(state, i, &move)) {
+            analysis->claimable[i] = 1;
+            analysis->claimColor[i] = move.claimRoute.color;
+            analysis->claimLocomotives[i] = move.claimRoute.nbLocomotives;
+            analysis->claimableRoutes[analysis->nbClaimable++] = i;
+        }
+    }
+    
+    memset(analysis->inNetwork, 0, sizeof(analysis->inNetwork));
+    analysis->nbNetworkCities = 0;
+    for (int i = 0; i < state->nbClaimedRoutes; i++) {
+        int routeIndex = state->claimedRoutes[i];
+        if (routeIndex < 0 || routeIndex >= state->nbTracks) continue;
+        
+        int ends[2] = {state->routes[routeIndex].from, state->routes[routeIndex].to};
+        for (int e = 0; e < 2; e++) {
+            if (!analysis->inNetwork[ends[e]]) {
+                analysis->inNetwork[ends[e]] = 1;
+                analysis->networkCities[analysis->nbNetworkCities++] = ends[e];
+            }
+        }
+    }
+    
+    analysis->nbFrontierRoutes = 0;
+    for (int i = 0; i < state->nbTracks; i++) {
+        if (state->routes[i].owner == 0 &&
+            (analysis->inNetwork[state->routes[i].from] || analysis->inNetwork[state->routes[i].to])) {
+            analysis->frontierRoutes[analysis->nbFrontierRoutes++] = i;
+        }
+    }
+    
+    updateRouteObjectiveIndex(state, analysis);
+    computeTempo(state, &analysis->tempo);
+}
+
+int claimAnalyzedRoute(GameState* state, TurnAnalysis* analysis, int routeIndex, MoveData* moveData) {
+    if (!state || !analysis || routeIndex < 0 || routeIndex >= state->nbTracks) {
+        return 0;
+    }
+    
+    if (!analysis->claimable[routeIndex]) {
+        return 0;
+    }
+    
+    // Stalling: never be the one to trigger the end on a route no plan needs
+    if (analysis->tempo.mode == TEMPO_STALL && state->wagonsLeft - state->routes[routeIndex].length <= 2 &&
+        analysis->routeIndex.routeObjectives[routeIndex] == 0) {
+        return 0;
+    }
+    
+    moveData->action = CLAIM_ROUTE;
+    moveData->claimRoute.from = state->routes[routeIndex].from;
+    moveData->claimRoute.to = state->routes[routeIndex].to;
+    moveData->claimRoute.color = analysis->claimColor[routeIndex];
+    moveData->claimRoute.nbLocomotives = analysis->claimLocomotives[routeIndex];
+    
+    return 1;
+}
\ No newline at end of file
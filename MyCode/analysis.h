@@ -0,0 +1,58 @@
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+#include "gamestate.h"
+#include "tempo.h"
+#include "../tickettorideapi/ticketToRide.h"
+
+typedef struct {
+    int open;              // not completed and still reachable
+    int distance;          // findSmartestPath cost, -1 if no path
+    int path[MAX_CITIES];
+    int pathLength;
+    int missingRoutes[MAX_CITIES];
+    int nbMissing;
+    int routesOwned;
+    int routesBlocked;
+    int blocked;           // no path, or every missing segment taken
+} ObjectiveAnalysis;
+
+// Inverted index: route -> objectives whose current plan uses it
+typedef struct {
+    int planRoutes[MAX_OBJECTIVES][MAX_CITIES * 2];  // free routes on the plan, parallels included
+    int nbPlanRoutes[MAX_OBJECTIVES];
+    int planScore[MAX_OBJECTIVES];
+    int nbPlans;
+    
+    int routeObjectives[MAX_ROUTES];  // plans using the route
+    int routeValue[MAX_ROUTES];       // summed score of those plans
+    int candidates[MAX_ROUTES];       // routes used by at least one plan
+    int candidatePos[MAX_ROUTES];     // position + 1 in candidates, 0 if absent
+    int nbCandidates;
+} RouteObjectiveIndex;
+
+typedef struct {
+    int totalCards;
+    
+    ObjectiveAnalysis objectives[MAX_OBJECTIVES];
+    
+    int claimable[MAX_ROUTES];
+    CardColor claimColor[MAX_ROUTES];
+    int claimLocomotives[MAX_ROUTES];
+    int claimableRoutes[MAX_ROUTES];
+    int nbClaimable;
+    
+    int inNetwork[MAX_CITIES];
+    int networkCities[MAX_CITIES];
+    int nbNetworkCities;
+    int frontierRoutes[MAX_ROUTES];  // free routes touching our network
+    int nbFrontierRoutes;
+    
+    RouteObjectiveIndex routeIndex;  // kept across turns, patched when a plan changes
+    
+    TempoModel tempo;
+} TurnAnalysis;
+
+void computeTurnAnalysis(GameState* state, TurnAnalysis* analysis);
+int claimAnalyzedRoute(GameState* state, TurnAnalysis* analysis, int routeIndex, MoveData* moveData);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,251 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "book.h"
+
+#define FNV_OFFSET 1469598103934665603ULL
+#define FNV_PRIME 1099511628211ULL
+
+// Mapped read-only once at startup, shared by every game of the session
+static const BookHeader* bookHeader = NULL;
+static const BookEntry* bookSlots = NULL;
+static size_t bookSize = 0;
+
+static uint64_t fnvBytes(uint64_t hash, const void* data, size_t size) {
+    const uint8_t* bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+uint64_t computeMapHash(GameState* state) {
+    uint64_t hash = fnvBytes(FNV_OFFSET, &state->nbCities, sizeof(int));
+    for (int i = 0; i < state->nbTracks; i++) {
+        int track[5] = {state->routes[i].from, state->routes[i].to, state->routes[i].length,
+                        state->routes[i].color, state->routes[i].secondColor};
+        hash = fnvBytes(hash, track, sizeof(track));
+    }
+    return hash;
+}
+
+// Coarse hand summary: the colour we hold most of and how many
+int handBucket(GameState* state) {
+    int bestColor = 0;
+    int bestCount = 0;
+    
+    for (int c = PURPLE; c <= GREEN; c++) {
+        if (state->nbCardsByColor[c] > bestCount) {
+            bestColor = c;
+            bestCount = state->nbCardsByColor[c];
+        }
+    }
+    
+    if (bestCount > 4) bestCount = 4;
+    return bestColor * 5 + bestCount;
+}
+
+static int ticketAfter(const unsigned int* a, const unsigned int* b) {
+    for (int i = 0; i < 3; i++) {
+        if (a[i] != b[i]) return a[i] > b[i];
+    }
+    return 0;
+}
+
+// Tickets sorted so any deal order finds the same entry; order[k] = input index of canonical k
+int canonicalTickets(Objective* objectives, uint8_t* tickets, int* order) {
+    unsigned int keys[3][3];
+    
+    for (int i = 0; i < 3; i++) {
+        unsigned int from = objectives[i].from;
+        unsigned int to = objectives[i].to;
+        if (from > to) {
+            unsigned int tmp = from;
+            from = to;
+            to = tmp;
+        }
+        if (to > 255 || objectives[i].score > 255) {
+            return 0;
+        }
+        keys[i][0] = from;
+        keys[i][1] = to;
+        keys[i][2] = objectives[i].score;
+        order[i] = i;
+    }
+    
+    for (int i = 1; i < 3; i++) {
+        int cur = order[i];
+        int j = i - 1;
+        while (j >= 0 && ticketAfter(keys[order[j]], keys[cur])) {
+            order[j + 1] = order[j];
+            j--;
+        }
+        order[j + 1] = cur;
+    }
+    
+    for (int k = 0; k < 3; k++) {
+        tickets[k * 3] = keys[order[k]][0];
+        tickets[k * 3 + 1] = keys[order[k]][1];
+        tickets[k * 3 + 2] = keys[order[k]][2];
+    }
+    return 1;
+}
+
+uint64_t bookKey(const uint8_t* tickets, int bucket) {
+    uint8_t bucketByte = bucket;
+    uint64_t hash = fnvBytes(FNV_OFFSET, tickets, 9);
+    hash = fnvBytes(hash, &bucketByte, 1);
+    return hash | 1;
+}
+
+int loadOpeningBook(const char* path) {
+    closeOpeningBook();
+    
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(BookHeader)) {
+        close(fd);
+        return 0;
+    }
+    
+    void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return 0;
+    }
+    
+    const BookHeader* header = data;
+    size_t expected = sizeof(BookHeader) + (size_t)header->nbSlots * sizeof(BookEntry);
+    int valid = memcmp(header->magic, BOOK_MAGIC, sizeof(BOOK_MAGIC)) == 0 &&
+                header->version == BOOK_VERSION &&
+                header->entrySize == sizeof(BookEntry) &&
+                header->nbSlots > 0 && (header->nbSlots & (header->nbSlots - 1)) == 0 &&
+                (size_t)st.st_size == expected;
+    
+    if (!valid) {
+        printf("Opening book %s: bad header or version, ignored\n", path);
+        munmap(data, st.st_size);
+        return 0;
+    }
+    
+    bookHeader = header;
+    bookSlots = (const BookEntry*)(header + 1);
+    bookSize = st.st_size;
+    return 1;
+}
+
+void closeOpeningBook(void) {
+    if (bookHeader) {
+        munmap((void*)bookHeader, bookSize);
+    }
+    bookHeader = NULL;
+    bookSlots = NULL;
+    bookSize = 0;
+}
+
+// A book for another map is silently skipped by lookupOpening: say so once per map
+void checkOpeningBookMap(const GameState* state) {
+    static uint64_t reportedMap = 0;
+    if (!bookHeader || bookHeader->mapHash == state->mapHash || reportedMap == state->mapHash) {
+        return;
+    }
+    
+    reportedMap = state->mapHash;
+    printf("Opening book built for map %016llx, this game is on map %016llx: book not used\n",
+           (unsigned long long)bookHeader->mapHash, (unsigned long long)state->mapHash);
+}
+
+// Keep-set and first claims for this deal, 0 to fall back on live analysis
+int lookupOpening(GameState* state, Objective* objectives, unsigned char* chooseObjectives) {
+    if (!bookHeader || !state || bookHeader->mapHash != state->mapHash) {
+        return 0;
+    }
+    
+    uint8_t tickets[9];
+    int order[3];
+    if (!canonicalTickets(objectives, tickets, order)) {
+        return 0;
+    }
+    
+    int bucket = handBucket(state);
+    uint64_t key = bookKey(tickets, bucket);
+    uint32_t mask = bookHeader->nbSlots - 1;
+    
+    for (uint32_t probe = 0, slot = key & mask; probe < bookHeader->nbSlots; probe++, slot = (slot + 1) & mask) {
+        const BookEntry* entry = &bookSlots[slot];
+        if (entry->key == 0) {
+            return 0;
+        }
+        if (entry->key != key || entry->handBucket != bucket || memcmp(entry->tickets, tickets, 9) != 0) {
+            continue;
+        }
+        
+        if (entry->keepMask == 0) {
+            return 0;
+        }
+        
+        for (int k = 0; k < 3; k++) {
+            chooseObjectives[order[k]] = (entry->keepMask >> k) & 1;
+        }
+        
+        state->nbOpeningClaims = 0;
+        for (int c = 0; c < entry->nbClaims && c < OPENING_CLAIMS; c++) {
+            if (entry->claims[c] < state->nbTracks) {
+                state->openingClaims[state->nbOpeningClaims++] = entry->claims[c];
+            }
+        }
+        return 1;
+    }
+    
+    return 0;
+}
+
+int writeOpeningBook(const char* path, uint64_t mapHash, BookEntry* entries, int nbEntries) {
+    uint32_t nbSlots = 1;
+    while (nbSlots < (uint32_t)nbEntries * 2) {
+        nbSlots <<= 1;
+    }
+    
+    BookEntry* slots = calloc(nbSlots, sizeof(BookEntry));
+    if (!slots) {
+        return 0;
+    }
+    
+    uint32_t mask = nbSlots - 1;
+    for (int i = 0; i < nbEntries; i++) {
+        uint32_t slot = entries[i].key & mask;
+        while (slots[slot].key != 0) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = entries[i];
+    }
+    
+    BookHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BOOK_MAGIC, sizeof(BOOK_MAGIC));
+    header.version = BOOK_VERSION;
+    header.entrySize = sizeof(BookEntry);
+    header.mapHash = mapHash;
+    header.nbSlots = nbSlots;
+    header.nbEntries = nbEntries;
+    
+    FILE* file = fopen(path, "wb");
+    int ok = file != NULL;
+    if (ok) {
+        ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+             fwrite(slots, sizeof(BookEntry), nbSlots, file) == nbSlots;
+        ok = (fclose(file) == 0) && ok;
+    }
+    
+    free(slots);
+    return ok;
+}
\ No newline at end of file
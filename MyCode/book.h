@@ -0,0 +1,43 @@
+#ifndef BOOK_H
+#define BOOK_H
+#include <stdint.h>
+#include "gamestate.h"
+#include "../tickettorideapi/ticketToRide.h"
+
+#define BOOK_MAGIC "T2RBOOK"
+#define BOOK_VERSION 1
+#define BOOK_HAND_BUCKETS 45   // best colour (0 = locomotives only) x its count 0..4
+#define OPENING_BOOK_FILE "opening.book"
+
+// On-disk layout, native byte order: header then an open-addressing slot table
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t entrySize;
+    uint64_t mapHash;
+    uint32_t nbSlots;      // power of two
+    uint32_t nbEntries;
+} BookHeader;
+
+typedef struct {
+    uint64_t key;          // 0 = empty slot
+    uint8_t tickets[9];    // from, to, score x3, canonical order
+    uint8_t handBucket;
+    uint8_t keepMask;      // bit i keeps canonical ticket i
+    uint8_t nbClaims;
+    uint16_t claims[OPENING_CLAIMS];  // route indices, first claim first
+    uint8_t reserved[4];
+} BookEntry;
+
+uint64_t computeMapHash(GameState* state);
+int handBucket(GameState* state);
+int canonicalTickets(Objective* objectives, uint8_t* tickets, int* order);
+uint64_t bookKey(const uint8_t* tickets, int bucket);
+
+int loadOpeningBook(const char* path);
+void closeOpeningBook(void);
+void checkOpeningBookMap(const GameState* state);
+int lookupOpening(GameState* state, Objective* objectives, unsigned char* chooseObjectives);
+int writeOpeningBook(const char* path, uint64_t mapHash, BookEntry* entries, int nbEntries);
+
+#endif
\ No newline at end of file
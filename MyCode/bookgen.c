@@ -0,0 +1,233 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gamestate.h"
+#include "analysis.h"
+#include "chokepoints.h"
+#include "book.h"
+#include "engine.h"
+
+// Offline opening book builder: ./bookgen <map file> <book file> [rollouts]
+// Map file, one item per line ('#' starts a comment):
+//   cities <n>
+//   route <from> <to> <length> <color> <secondColor>
+//   ticket <from> <to> <score>
+
+#define DEFAULT_ROLLOUTS 8     // engine games per keep-set
+#define MIN_OPENING_KEEP 2
+
+static EngineMap map;
+static Engine engine;
+static GameState baseState;
+static GameState state;
+static TurnAnalysis analysis;
+
+// Representative opening hand for a bucket, 0 if the bucket cannot be dealt
+static int dealBucket(int bucket) {
+    int bestColor = bucket / 5;
+    int bestCount = bucket % 5;
+    
+    if ((bestColor == 0) != (bestCount == 0)) {
+        return 0;
+    }
+    
+    memcpy(&state, &baseState, sizeof(GameState));
+    
+    int dealt = 0;
+    for (; dealt < bestCount; dealt++) {
+        addCardToHand(&state, bestColor);
+    }
+    
+    // Filler never beats the bucket colour: singles of later colours, locomotives otherwise
+    int filler = bestColor + 1;
+    for (; dealt < 4; dealt++) {
+        if (bestCount >= 2 && filler <= GREEN) {
+            addCardToHand(&state, filler++);
+        } else {
+            addCardToHand(&state, LOCOMOTIVE);
+        }
+    }
+    
+    return handBucket(&state) == bucket;
+}
+
+// Summed score lead over engine games opened with these tickets: we build the
+// tickets, the opponent plays greedy. Every keep-set of a deal sees the same seeds.
+static int rolloutLead(const Objective* kept, int nbKept, uint64_t dealSeed, int rollouts) {
+    int lead = 0;
+    
+    for (int k = 0; k < rollouts; k++) {
+        EngineRng rng;
+        seedRng(&rng, dealSeed ^ ((uint64_t)(k + 1) * 0xD1B54A32D192ED03ULL));
+        startEngineGame(&engine, &map, nextRandom(&rng), k % ENGINE_PLAYERS);
+        giveEngineTickets(&engine, 0, kept, nbKept);
+        
+        while (!engine.over) {
+            int player = engine.current;
+            MoveData move;
+            MoveResult result;
+            
+            scriptedMove(&engine, player, player == 0 ? SCRIPT_TICKETS : SCRIPT_GREEDY, &rng, &move);
+            if (playEngineMove(&engine, player, &move, &result) == ILLEGAL_MOVE) {
+                memset(&move, 0, sizeof(MoveData));
+                move.action = DRAW_BLIND_CARD;
+                if (playEngineMove(&engine, player, &move, &result) == ILLEGAL_MOVE) {
+                    break;
+                }
+            }
+        }
+        
+        EngineScore scores[ENGINE_PLAYERS];
+        scoreEngineGame(&engine, scores);
+        lead += scores[0].total - scores[1].total;
+    }
+    
+    return lead;
+}
+
+// Keep-set with the best rollout lead, at least two tickets as on the opening turn.
+// Hands come from the engine's deal: the tickets weigh far more than four cards,
+// and one decision per triple keeps the book buildable for large ticket sets.
+static void chooseOpeningKeep(Objective* deal, uint64_t dealSeed, int rollouts, unsigned char* keep) {
+    int bestMask = 0;
+    int bestLead = 0;
+    for (int mask = 1; mask < 8; mask++) {
+        if (__builtin_popcount(mask) < MIN_OPENING_KEEP) continue;
+        
+        Objective kept[3];
+        int nbKept = 0;
+        for (int i = 0; i < 3; i++) {
+            if (mask & (1 << i)) {
+                kept[nbKept++] = deal[i];
+            }
+        }
+        
+        int lead = rolloutLead(kept, nbKept, dealSeed, rollouts);
+        if (bestMask == 0 || lead > bestLead) {
+            bestMask = mask;
+            bestLead = lead;
+        }
+    }
+    
+    for (int i = 0; i < 3; i++) {
+        keep[i] = (bestMask >> i) & 1;
+    }
+}
+
+// Routes of the kept plans, the ones most plans share and the hand can pay first
+static int openingClaims(uint16_t* claims) {
+    CardColor bestColor = handBucket(&state) / 5;
+    int nbClaims = 0;
+    int used[MAX_ROUTES] = {0};
+    
+    computeTurnAnalysis(&state, &analysis);
+    RouteObjectiveIndex* index = &analysis.routeIndex;
+    
+    while (nbClaims < OPENING_CLAIMS) {
+        int best = -1;
+        int bestPriority = 0;
+        
+        for (int k = 0; k < index->nbCandidates; k++) {
+            int r = index->candidates[k];
+            if (used[r]) continue;
+            
+            Route* route = &state.routes[r];
+            int priority = index->routeValue[r] * 4 + routeChokepoint(&state, r) * 8 + route->length;
+            if (route->color == bestColor || route->secondColor == bestColor || route->color == LOCOMOTIVE) {
+                priority += 6;
+            }
+            
+            if (best < 0 || priority > bestPriority) {
+                best = r;
+                bestPriority = priority;
+            }
+        }
+        
+        if (best < 0) break;
+        used[best] = 1;
+        claims[nbClaims++] = best;
+    }
+    
+    return nbClaims;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3 && argc != 4) {
+        printf("Usage: %s <map file> <book file> [rollouts]\n", argv[0]);
+        return 1;
+    }
+    
+    int rollouts = argc == 4 ? atoi(argv[3]) : DEFAULT_ROLLOUTS;
+    if (rollouts < 1) {
+        printf("Need at least one rollout per keep-set\n");
+        return 1;
+    }
+    
+    GameData gameData;
+    if (!loadEngineMap(&map, argv[1])) {
+        return 1;
+    }
+    
+    mapGameData(&map, &gameData);
+    initGameState(&baseState, &gameData);
+    
+    int maxEntries = map.nbTickets * (map.nbTickets - 1) * (map.nbTickets - 2) / 6 * BOOK_HAND_BUCKETS;
+    BookEntry* entries = malloc(sizeof(BookEntry) * maxEntries);
+    if (!entries) {
+        printf("Not enough memory for %d entries\n", maxEntries);
+        return 1;
+    }
+    
+    int nbEntries = 0;
+    int nbTriples = 0;
+    for (int a = 0; a < map.nbTickets; a++) {
+        for (int b = a + 1; b < map.nbTickets; b++) {
+            for (int c = b + 1; c < map.nbTickets; c++) {
+                Objective deal[3] = {map.tickets[a], map.tickets[b], map.tickets[c]};
+                uint8_t canonical[9];
+                int order[3];
+                if (!canonicalTickets(deal, canonical, order)) {
+                    continue;
+                }
+                
+                unsigned char keep[3];
+                chooseOpeningKeep(deal, bookKey(canonical, 0), rollouts, keep);
+                
+                for (int bucket = 0; bucket < BOOK_HAND_BUCKETS; bucket++) {
+                    if (!dealBucket(bucket)) continue;
+                    
+                    BookEntry* entry = &entries[nbEntries];
+                    memset(entry, 0, sizeof(BookEntry));
+                    memcpy(entry->tickets, canonical, 9);
+                    entry->handBucket = bucket;
+                    entry->key = bookKey(canonical, bucket);
+                    
+                    for (int k = 0; k < 3; k++) {
+                        if (keep[order[k]]) {
+                            entry->keepMask |= 1 << k;
+                            addObjectives(&state, &deal[order[k]], 1);
+                        }
+                    }
+                    if (entry->keepMask == 0) continue;
+                    
+                    entry->nbClaims = openingClaims(entry->claims);
+                    nbEntries++;
+                }
+                
+                if (++nbTriples % 1000 == 0) {
+                    printf("%d ticket triples, %d entries\n", nbTriples, nbEntries);
+                }
+            }
+        }
+    }
+    
+    if (!writeOpeningBook(argv[2], computeMapHash(&baseState), entries, nbEntries)) {
+        printf("Cannot write %s\n", argv[2]);
+        free(entries);
+        return 1;
+    }
+    
+    printf("Opening book %s: %d entries for %d tickets\n", argv[2], nbEntries, map.nbTickets);
+    free(entries);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,272 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "chokepoints.h"
+#include "rules.h"
+#include "reachability.h"
+
+#define INF_DIST 999999
+#define REGION_SLACK 4
+#define IN_REGION 1
+#define ARTICULATION 2
+
+void initChokepoints(GameState* state) {
+    if (!state) {
+        return;
+    }
+    
+    memset(state->routeChokepoint, 0, sizeof(state->routeChokepoint));
+    memset(state->cityArticulation, 0, sizeof(state->cityArticulation));
+    memset(state->chokeRegion, 0, sizeof(state->chokeRegion));
+    memset(state->objectiveChokeRegion, 0, sizeof(state->objectiveChokeRegion));
+    memset(state->objectiveChokepoints, 0, sizeof(state->objectiveChokepoints));
+    memset(state->objectiveChokeDirty, 0, sizeof(state->objectiveChokeDirty));
+    state->chokeObjectivesSeen = 0;
+    state->chokepointDirty = 1;
+}
+
+void chokepointsRouteChanged(GameState* state, int routeIndex) {
+    if (!state || routeIndex < 0 || routeIndex >= state->nbTracks) {
+        return;
+    }
+    
+    // Only objectives whose region holds the route can see their flags change
+    int from = state->routes[routeIndex].from;
+    int to = state->routes[routeIndex].to;
+    for (int i = 0; i < state->chokeObjectivesSeen; i++) {
+        if ((state->objectiveChokeRegion[i][from] & IN_REGION) &&
+            (state->objectiveChokeRegion[i][to] & IN_REGION)) {
+            state->objectiveChokeDirty[i] = 1;
+            state->chokepointDirty = 1;
+        }
+    }
+}
+
+// Objectives are only ever appended, so the new ones are those not seen yet
+void chokepointsObjectivesChanged(GameState* state) {
+    if (!state) {
+        return;
+    }
+    
+    for (int i = state->chokeObjectivesSeen; i < state->nbObjectives; i++) {
+        state->objectiveChokeDirty[i] = 1;
+        state->chokepointDirty = 1;
+    }
+    state->chokeObjectivesSeen = state->nbObjectives;
+}
+
+// Dijkstra over free and owned routes, optionally without one route
+static void distancesFrom(GameState* state, int start, int excludedRoute, int* dist) {
+    int visited[MAX_CITIES];
+    
+    for (int i = 0; i < state->nbCities; i++) {
+        dist[i] = INF_DIST;
+        visited[i] = 0;
+    }
+    dist[start] = 0;
+    
+    for (int count = 0; count < state->nbCities; count++) {
+        int u = -1;
+        int minDist = INF_DIST;
+        
+        for (int i = 0; i < state->nbCities; i++) {
+            if (!visited[i] && dist[i] < minDist) {
+                minDist = dist[i];
+                u = i;
+            }
+        }
+        
+        if (u == -1) break;
+        visited[u] = 1;
+        
+        for (int i = 0; i < state->nbTracks; i++) {
+            if (i == excludedRoute || state->routes[i].owner == 2) continue;
+            
+            int from = state->routes[i].from;
+            int to = state->routes[i].to;
+            if (from != u && to != u) continue;
+            
+            int v = (from == u) ? to : from;
+            int length = (state->routes[i].owner == 1) ? 0 : state->routes[i].length;
+            
+            if (dist[u] + length < dist[v]) {
+                dist[v] = dist[u] + length;
+            }
+        }
+    }
+}
+
+typedef struct {
+    unsigned char* region;
+    int timer;
+    int tin[MAX_CITIES];
+    int tout[MAX_CITIES];
+    int low[MAX_CITIES];
+    int isBridge[MAX_ROUTES];
+} TarjanData;
+
+static void tarjanVisit(GameState* state, TarjanData* data, int u, int parentRoute) {
+    data->tin[u] = data->low[u] = ++data->timer;
+    int children = 0;
+    
+    for (int i = 0; i < state->nbTracks; i++) {
+        // Skip by route index, not by city, so double routes are never bridges
+        if (i == parentRoute || state->routes[i].owner == 2) continue;
+        
+        int from = state->routes[i].from;
+        int to = state->routes[i].to;
+        if (from != u && to != u) continue;
+        
+        int v = (from == u) ? to : from;
+        if (!(data->region[v] & IN_REGION)) continue;
+        
+        if (data->tin[v]) {
+            if (data->tin[v] < data->low[u]) {
+                data->low[u] = data->tin[v];
+            }
+            continue;
+        }
+        
+        tarjanVisit(state, data, v, i);
+        children++;
+        
+        if (data->low[v] < data->low[u]) {
+            data->low[u] = data->low[v];
+        }
+        
+        if (data->low[v] > data->tin[u]) {
+            data->isBridge[i] = 1;
+        }
+        
+        if (parentRoute >= 0 && data->low[v] >= data->tin[u]) {
+            data->region[u] |= ARTICULATION;
+        }
+    }
+    
+    if (parentRoute < 0 && children > 1) {
+        data->region[u] |= ARTICULATION;
+    }
+    
+    data->tout[u] = data->timer;
+}
+
+static int inSubtree(TarjanData* data, int root, int city) {
+    return data->tin[city] >= data->tin[root] && data->tin[city] <= data->tout[root];
+}
+
+// Region, bridges and costly routes of one objective, from scratch
+static void refreshObjective(GameState* state, int index) {
+    unsigned char* region = state->objectiveChokeRegion[index];
+    unsigned char* flags = state->objectiveChokepoints[index];
+    Objective* obj = &state->objectives[index];
+    
+    memset(region, 0, MAX_CITIES);
+    memset(flags, 0, MAX_ROUTES);
+    if (!isObjectiveOpen(state, *obj)) {
+        return;
+    }
+    
+    int distFrom[MAX_CITIES];
+    int distTo[MAX_CITIES];
+    distancesFrom(state, obj->from, -1, distFrom);
+    distancesFrom(state, obj->to, -1, distTo);
+    
+    int cost = distFrom[obj->to];
+    if (cost >= INF_DIST) {
+        return;
+    }
+    
+    // Region: cities on near-shortest paths of the objective
+    int bound = cost + cost / 2 + REGION_SLACK;
+    for (int c = 0; c < state->nbCities; c++) {
+        if (distFrom[c] + distTo[c] <= bound) {
+            region[c] = IN_REGION;
+        }
+    }
+    
+    TarjanData data;
+    memset(&data, 0, sizeof(data));
+    data.region = region;
+    
+    for (int c = 0; c < state->nbCities; c++) {
+        if ((region[c] & IN_REGION) && !data.tin[c]) {
+            tarjanVisit(state, &data, c, -1);
+        }
+    }
+    
+    // Bridges separating the two ends of the objective
+    for (int r = 0; r < state->nbTracks; r++) {
+        if (!data.isBridge[r] || state->routes[r].owner != 0) continue;
+        
+        int from = state->routes[r].from;
+        int to = state->routes[r].to;
+        int child = (data.tin[from] > data.tin[to]) ? from : to;
+        
+        if (inSubtree(&data, child, obj->from) != inSubtree(&data, child, obj->to)) {
+            flags[r] = CHOKEPOINT_DISCONNECTS;
+        }
+    }
+    
+    // Free routes on current shortest paths whose loss makes the detour expensive
+    for (int r = 0; r < state->nbTracks; r++) {
+        if (state->routes[r].owner != 0 || flags[r] != CHOKEPOINT_NONE) continue;
+        
+        int a = state->routes[r].from;
+        int b = state->routes[r].to;
+        int length = state->routes[r].length;
+        
+        int onPath = (distFrom[a] + length + distTo[b] == cost) ||
+                     (distFrom[b] + length + distTo[a] == cost);
+        if (!onPath) continue;
+        
+        int withoutRoute[MAX_CITIES];
+        distancesFrom(state, obj->from, r, withoutRoute);
+        
+        int extra = withoutRoute[obj->to] - cost;
+        if (withoutRoute[obj->to] >= INF_DIST) {
+            flags[r] = CHOKEPOINT_DISCONNECTS;
+        } else if (extra >= 3 && extra * 2 >= cost) {
+            flags[r] = CHOKEPOINT_COSTLY;
+        }
+    }
+}
+
+// Recomputes only the objectives touched since the last call, then merges
+void updateChokepoints(GameState* state) {
+    if (!state || !state->chokepointDirty) {
+        return;
+    }
+    state->chokepointDirty = 0;
+    
+    for (int i = 0; i < state->chokeObjectivesSeen; i++) {
+        if (state->objectiveChokeDirty[i]) {
+            state->objectiveChokeDirty[i] = 0;
+            refreshObjective(state, i);
+        }
+    }
+    
+    memset(state->routeChokepoint, 0, sizeof(state->routeChokepoint));
+    memset(state->cityArticulation, 0, sizeof(state->cityArticulation));
+    memset(state->chokeRegion, 0, sizeof(state->chokeRegion));
+    
+    for (int i = 0; i < state->chokeObjectivesSeen; i++) {
+        for (int c = 0; c < state->nbCities; c++) {
+            state->chokeRegion[c] |= state->objectiveChokeRegion[i][c] & IN_REGION;
+            state->cityArticulation[c] |= (state->objectiveChokeRegion[i][c] & ARTICULATION) ? 1 : 0;
+        }
+        for (int r = 0; r < state->nbTracks; r++) {
+            if (state->objectiveChokepoints[i][r] > state->routeChokepoint[r]) {
+                state->routeChokepoint[r] = state->objectiveChokepoints[i][r];
+            }
+        }
+    }
+}
+
+int routeChokepoint(GameState* state, int routeIndex) {
+    if (!state || routeIndex < 0 || routeIndex >= state->nbTracks) {
+        return CHOKEPOINT_NONE;
+    }
+    
+    updateChokepoints(state);
+    return state->routeChokepoint[routeIndex];
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+#ifndef CHOKEPOINTS_H
+#define CHOKEPOINTS_H
+#include "gamestate.h"
+
+#define CHOKEPOINT_NONE 0
+#define CHOKEPOINT_COSTLY 1        // losing it raises an objective's cost sharply
+#define CHOKEPOINT_DISCONNECTS 2   // losing it cuts an objective
+
+void initChokepoints(GameState* state);
+void chokepointsRouteChanged(GameState* state, int routeIndex);
+void chokepointsObjectivesChanged(GameState* state);
+void updateChokepoints(GameState* state);
+int routeChokepoint(GameState* state, int routeIndex);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,246 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "contention.h"
+#include "opponent.h"
+#include "chokepoints.h"
+#include "rules.h"
+
+#define THREAT_DECAY 0.8f
+#define MAX_SCHEDULED 64
+
+void initContention(GameState* state) {
+    if (!state) {
+        return;
+    }
+    
+    for (int i = 0; i < MAX_ROUTES; i++) {
+        state->routeThreat[i] = 0;
+        state->routeScarcity[i] = -1;
+    }
+    for (int i = 0; i < MAX_CITIES; i++) {
+        state->opponentCities[i] = 0;
+    }
+    state->scarcityVersion = state->ownershipVersion;
+}
+
+static void bumpRoutesAt(GameState* state, int city, float amount, CardColor color) {
+    for (int i = 0; i < state->nbTracks; i++) {
+        if (state->routes[i].owner != 0) continue;
+        if (state->routes[i].from != city && state->routes[i].to != city) continue;
+        
+        if (color != NONE && state->routes[i].color != color &&
+            state->routes[i].secondColor != color && state->routes[i].color != LOCOMOTIVE) {
+            continue;
+        }
+        
+        state->routeThreat[i] += amount;
+    }
+}
+
+void contentionAfterOpponentMove(GameState* state, MoveData* moveData, int routeIndex) {
+    if (!state || !moveData) {
+        return;
+    }
+    
+    switch (moveData->action) {
+        case CLAIM_ROUTE:
+            {
+                if (routeIndex < 0 || routeIndex >= state->nbTracks) {
+                    break;
+                }
+                
+                // Older claims matter less than where the opponent is building now
+                for (int i = 0; i < state->nbTracks; i++) {
+                    state->routeThreat[i] *= THREAT_DECAY;
+                }
+                state->routeThreat[routeIndex] = 0;
+                
+                int from = state->routes[routeIndex].from;
+                int to = state->routes[routeIndex].to;
+                state->opponentCities[from] = 1;
+                state->opponentCities[to] = 1;
+                
+                bumpRoutesAt(state, from, 1.0f, NONE);
+                bumpRoutesAt(state, to, 1.0f, NONE);
+            }
+            break;
+        
+        case DRAW_CARD:
+            {
+                // A face-up pick hints at routes of that colour on their frontier
+                for (int c = 0; c < state->nbCities; c++) {
+                    if (state->opponentCities[c]) {
+                        bumpRoutesAt(state, c, 0.3f, moveData->drawCard);
+                    }
+                }
+            }
+            break;
+        
+        default:
+            break;
+    }
+}
+
+float routeTakeRisk(GameState* state, int routeIndex, int turnsAway) {
+    if (!state || routeIndex < 0 || routeIndex >= state->nbTracks) {
+        return 0;
+    }
+    
+    if (state->routes[routeIndex].owner != 0) {
+        return 0;
+    }
+    
+    float threat = state->routeThreat[routeIndex];
+    if (threat > 3) threat = 3;
+    
+    int onFrontier = state->opponentCities[state->routes[routeIndex].from] ||
+                     state->opponentCities[state->routes[routeIndex].to];
+    
+    // Per opponent turn hazard: interest in the area, scaled by their hand
+    float hazard = 0.02f + 0.08f * threat + (onFrontier ? 0.05f : 0);
+    hazard *= 0.3f + 0.7f * opponentClaimProbability(state, routeIndex);
+    if (hazard > 0.9f) hazard = 0.9f;
+    
+    if (turnsAway < 1) turnsAway = 1;
+    
+    float survive = 1;
+    for (int t = 0; t < turnsAway; t++) {
+        survive *= (1 - hazard);
+    }
+    
+    return 1 - survive;
+}
+
+// Dijkstra from one end of a route to the other without using it
+static int detourCost(GameState* state, int routeIndex) {
+    int start = state->routes[routeIndex].from;
+    int end = state->routes[routeIndex].to;
+    
+    int dist[MAX_CITIES];
+    int visited[MAX_CITIES];
+    
+    for (int i = 0; i < state->nbCities; i++) {
+        dist[i] = 999999;
+        visited[i] = 0;
+    }
+    dist[start] = 0;
+    
+    for (int count = 0; count < state->nbCities; count++) {
+        int u = -1;
+        int minDist = 999999;
+        
+        for (int i = 0; i < state->nbCities; i++) {
+            if (!visited[i] && dist[i] < minDist) {
+                minDist = dist[i];
+                u = i;
+            }
+        }
+        
+        if (u == -1 || u == end) break;
+        visited[u] = 1;
+        
+        for (int i = 0; i < state->nbTracks; i++) {
+            if (i == routeIndex || state->routes[i].owner == 2) continue;
+            
+            int from = state->routes[i].from;
+            int to = state->routes[i].to;
+            if (from != u && to != u) continue;
+            
+            int v = (from == u) ? to : from;
+            int length = (state->routes[i].owner == 1) ? 0 : state->routes[i].length;
+            
+            if (dist[u] + length < dist[v]) {
+                dist[v] = dist[u] + length;
+            }
+        }
+    }
+    
+    return dist[end];
+}
+
+float routeScarcity(GameState* state, int routeIndex) {
+    if (!state || routeIndex < 0 || routeIndex >= state->nbTracks) {
+        return 0;
+    }
+    
+    // Cached until a route changes hands
+    if (state->scarcityVersion != state->ownershipVersion) {
+        for (int i = 0; i < MAX_ROUTES; i++) {
+            state->routeScarcity[i] = -1;
+        }
+        state->scarcityVersion = state->ownershipVersion;
+    }
+    
+    if (state->routeScarcity[routeIndex] >= 0) {
+        return state->routeScarcity[routeIndex];
+    }
+    
+    int length = state->routes[routeIndex].length;
+    int detour = detourCost(state, routeIndex);
+    
+    float scarcity;
+    if (detour >= 999999) {
+        scarcity = 1.0f;
+    } else if (detour <= length) {
+        scarcity = 0;
+    } else {
+        scarcity = (float)(detour - length) / (detour + length);
+    }
+    
+    state->routeScarcity[routeIndex] = scarcity;
+    return scarcity;
+}
+
+float routeUrgency(GameState* state, int routeIndex, int turnsAway) {
+    float risk = routeTakeRisk(state, routeIndex, turnsAway);
+    float scarcity = routeScarcity(state, routeIndex);
+    
+    int chokepoint = routeChokepoint(state, routeIndex);
+    if (chokepoint == CHOKEPOINT_DISCONNECTS) {
+        scarcity += 0.5f;
+    } else if (chokepoint == CHOKEPOINT_COSTLY) {
+        scarcity += 0.25f;
+    }
+    
+    return risk * (0.25f + scarcity);
+}
+
+int scheduleClaims(GameState* state, int* path, int pathLength, int* order) {
+    if (!state || !path || !order) {
+        return 0;
+    }
+    
+    int count = 0;
+    float urgency[MAX_SCHEDULED];
+    
+    // Missing routes in path order; their position is how long they would wait
+    for (int i = 0; i < pathLength - 1 && count < MAX_SCHEDULED; i++) {
+        int routeIndex = findRouteIndex(state, path[i], path[i + 1]);
+        if (routeIndex < 0 || state->routes[routeIndex].owner != 0) {
+            continue;
+        }
+        
+        order[count] = routeIndex;
+        urgency[count] = routeUrgency(state, routeIndex, count + 1);
+        count++;
+    }
+    
+    // Stable insertion sort, most urgent first
+    for (int i = 1; i < count; i++) {
+        int route = order[i];
+        float value = urgency[i];
+        int j = i - 1;
+        
+        while (j >= 0 && urgency[j] < value) {
+            order[j + 1] = order[j];
+            urgency[j + 1] = urgency[j];
+            j--;
+        }
+        
+        order[j + 1] = route;
+        urgency[j + 1] = value;
+    }
+    
+    return count;
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+#ifndef CONTENTION_H
+#define CONTENTION_H
+#include "gamestate.h"
+#include "../tickettorideapi/ticketToRide.h"
+
+void initContention(GameState* state);
+void contentionAfterOpponentMove(GameState* state, MoveData* moveData, int routeIndex);
+float routeTakeRisk(GameState* state, int routeIndex, int turnsAway);
+float routeScarcity(GameState* state, int routeIndex);
+float routeUrgency(GameState* state, int routeIndex, int turnsAway);
+int scheduleClaims(GameState* state, int* path, int pathLength, int* order);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,771 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "engine.h"
+#include "rules.h"
+
+#define FACE_UP_LOCOMOTIVE_LIMIT 3
+#define FACE_UP_RESHUFFLES 3
+#define MIN_TICKET_SCORE 4
+#define MAX_TICKET_SCORE 22
+#define ENGINE_NO_PATH 999999
+
+// splitmix64: cheap, and any seed gives an independent-looking stream
+void seedRng(EngineRng* rng, uint64_t seed) {
+    rng->state = seed;
+}
+
+uint64_t nextRandom(EngineRng* rng) {
+    uint64_t z = (rng->state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+int randomBelow(EngineRng* rng, int n) {
+    return n > 0 ? (int)(nextRandom(rng) % (uint64_t)n) : 0;
+}
+
+static void addTrack(EngineMap* map, int from, int to, int length, int color, int secondColor) {
+    int* track = &map->trackData[map->nbTracks++ * 5];
+    track[0] = from;
+    track[1] = to;
+    track[2] = length;
+    track[3] = color;
+    track[4] = secondColor;
+}
+
+static int hasTrack(const EngineMap* map, int from, int to) {
+    for (int i = 0; i < map->nbTracks; i++) {
+        const int* track = &map->trackData[i * 5];
+        if ((track[0] == from && track[1] == to) || (track[0] == to && track[1] == from)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Ring of cities with short chords, tickets scored by shortest distance
+void generateEngineMap(EngineMap* map, EngineRng* rng, int nbCities, int nbTracks, int nbTickets) {
+    memset(map, 0, sizeof(EngineMap));
+    if (nbCities > MAX_CITIES) nbCities = MAX_CITIES;
+    if (nbCities < 4) nbCities = 4;
+    if (nbTracks > MAX_ROUTES) nbTracks = MAX_ROUTES;
+    if (nbTracks < nbCities) nbTracks = nbCities;
+    if (nbTickets > ENGINE_MAX_TICKETS) nbTickets = ENGINE_MAX_TICKETS;
+    map->nbCities = nbCities;
+    
+    for (int i = 0; i < nbCities; i++) {
+        addTrack(map, i, (i + 1) % nbCities, 1 + randomBelow(rng, 6), 1 + randomBelow(rng, 9), NONE);
+    }
+    
+    // One track per city pair like the real maps, double routes carry a second colour
+    for (int attempt = 0; map->nbTracks < nbTracks && attempt < nbTracks * 20; attempt++) {
+        int from = randomBelow(rng, nbCities);
+        int to = (from + 2 + randomBelow(rng, 5)) % nbCities;
+        if (from == to || hasTrack(map, from, to)) {
+            continue;
+        }
+        
+        int color = 1 + randomBelow(rng, 9);
+        int secondColor = (color != LOCOMOTIVE && randomBelow(rng, 3) == 0) ? 1 + randomBelow(rng, 8) : NONE;
+        addTrack(map, from, to, 1 + randomBelow(rng, 6), color, secondColor);
+    }
+    
+    int (*dist)[MAX_CITIES] = malloc(sizeof(int[MAX_CITIES][MAX_CITIES]));
+    if (!dist) {
+        return;
+    }
+    for (int a = 0; a < nbCities; a++) {
+        for (int b = 0; b < nbCities; b++) {
+            dist[a][b] = a == b ? 0 : 1 << 20;
+        }
+    }
+    for (int i = 0; i < map->nbTracks; i++) {
+        int* track = &map->trackData[i * 5];
+        if (track[2] < dist[track[0]][track[1]]) {
+            dist[track[0]][track[1]] = dist[track[1]][track[0]] = track[2];
+        }
+    }
+    for (int k = 0; k < nbCities; k++) {
+        for (int a = 0; a < nbCities; a++) {
+            for (int b = 0; b < nbCities; b++) {
+                if (dist[a][k] + dist[k][b] < dist[a][b]) {
+                    dist[a][b] = dist[a][k] + dist[k][b];
+                }
+            }
+        }
+    }
+    
+    while (map->nbTickets < nbTickets) {
+        int from = randomBelow(rng, nbCities);
+        int to = randomBelow(rng, nbCities);
+        if (dist[from][to] < MIN_TICKET_SCORE) {
+            continue;
+        }
+        
+        Objective* ticket = &map->tickets[map->nbTickets++];
+        ticket->from = from;
+        ticket->to = to;
+        ticket->score = dist[from][to] > MAX_TICKET_SCORE ? MAX_TICKET_SCORE : dist[from][to];
+    }
+    
+    free(dist);
+}
+
+// Text map: "cities n", "route from to length color secondColor", "ticket from to score"
+int loadEngineMap(EngineMap* map, const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        printf("Cannot open map file %s\n", path);
+        return 0;
+    }
+    
+    memset(map, 0, sizeof(EngineMap));
+    char line[256];
+    int ok = 1;
+    while (ok && fgets(line, sizeof(line), file)) {
+        int a, b, c, d, e;
+        if (line[0] == '#' || line[0] == '\n') {
+            continue;
+        }
+        
+        if (sscanf(line, "cities %d", &a) == 1) {
+            ok = a > 0 && a <= MAX_CITIES;
+            map->nbCities = a;
+        } else if (sscanf(line, "route %d %d %d %d %d", &a, &b, &c, &d, &e) == 5) {
+            ok = map->nbTracks < MAX_ROUTES && a >= 0 && b >= 0 && c > 0 && c <= 6 &&
+                 d >= NONE && d <= LOCOMOTIVE && e >= NONE && e <= LOCOMOTIVE;
+            if (ok) {
+                addTrack(map, a, b, c, d, e);
+            }
+        } else if (sscanf(line, "ticket %d %d %d", &a, &b, &c) == 3) {
+            ok = map->nbTickets < ENGINE_MAX_TICKETS && a >= 0 && b >= 0 && c >= 0;
+            if (ok) {
+                map->tickets[map->nbTickets].from = a;
+                map->tickets[map->nbTickets].to = b;
+                map->tickets[map->nbTickets].score = c;
+                map->nbTickets++;
+            }
+        } else {
+            ok = 0;
+        }
+    }
+    
+    fclose(file);
+    if (!ok) {
+        printf("Bad map file %s: %s", path, line);
+        return 0;
+    }
+    
+    for (int i = 0; i < map->nbTracks; i++) {
+        if (map->trackData[i * 5] >= map->nbCities || map->trackData[i * 5 + 1] >= map->nbCities) {
+            printf("Bad map file %s: route %d outside the map\n", path, i);
+            return 0;
+        }
+    }
+    
+    for (int i = 0; i < map->nbTickets; i++) {
+        if ((int)map->tickets[i].from >= map->nbCities || (int)map->tickets[i].to >= map->nbCities) {
+            printf("Bad map file %s: ticket %d outside the map\n", path, i);
+            return 0;
+        }
+    }
+    return map->nbCities > 0 && map->nbTracks > 0 && map->nbTickets >= 3;
+}
+
+void mapGameData(const EngineMap* map, GameData* gameData) {
+    memset(gameData, 0, sizeof(GameData));
+    gameData->nbCities = map->nbCities;
+    gameData->nbTracks = map->nbTracks;
+    gameData->trackData = (int*)map->trackData;
+}
+
+static CardColor drawFromDeck(Engine* engine) {
+    if (engine->deckSize == 0) {
+        memcpy(engine->deck, engine->discard, sizeof(CardColor) * engine->discardSize);
+        engine->deckSize = engine->discardSize;
+        engine->discardSize = 0;
+        for (int i = engine->deckSize - 1; i > 0; i--) {
+            int j = randomBelow(&engine->rng, i + 1);
+            CardColor tmp = engine->deck[i];
+            engine->deck[i] = engine->deck[j];
+            engine->deck[j] = tmp;
+        }
+    }
+    
+    return engine->deckSize > 0 ? engine->deck[--engine->deckSize] : NONE;
+}
+
+// Empty slots refilled; three face-up locomotives wipe the row
+static void refillFaceUp(Engine* engine) {
+    for (int attempt = 0; attempt <= FACE_UP_RESHUFFLES; attempt++) {
+        int locomotives = 0;
+        for (int i = 0; i < 5; i++) {
+            if (engine->faceUp[i] == NONE) {
+                engine->faceUp[i] = drawFromDeck(engine);
+            }
+            if (engine->faceUp[i] == LOCOMOTIVE) {
+                locomotives++;
+            }
+        }
+        
+        if (locomotives < FACE_UP_LOCOMOTIVE_LIMIT || attempt == FACE_UP_RESHUFFLES) {
+            return;
+        }
+        for (int i = 0; i < 5; i++) {
+            engine->discard[engine->discardSize++] = engine->faceUp[i];
+            engine->faceUp[i] = NONE;
+        }
+    }
+}
+
+static int cardsLeft(const Engine* engine) {
+    int count = engine->deckSize + engine->discardSize;
+    for (int i = 0; i < 5; i++) {
+        if (engine->faceUp[i] != NONE) count++;
+    }
+    return count;
+}
+
+void startEngineGame(Engine* engine, const EngineMap* map, uint64_t seed, int starter) {
+    memset(engine, 0, sizeof(Engine));
+    engine->map = map;
+    seedRng(&engine->rng, seed);
+    
+    for (int i = 0; i < map->nbTracks; i++) {
+        engine->routeOwner[i] = -1;
+    }
+    
+    for (int c = PURPLE; c <= GREEN; c++) {
+        for (int k = 0; k < 12; k++) {
+            engine->discard[engine->discardSize++] = c;
+        }
+    }
+    for (int k = 0; k < 14; k++) {
+        engine->discard[engine->discardSize++] = LOCOMOTIVE;
+    }
+    
+    for (int p = 0; p < ENGINE_PLAYERS; p++) {
+        for (int k = 0; k < 4; k++) {
+            CardColor card = drawFromDeck(engine);
+            engine->startCards[p][k] = card;
+            engine->hand[p][card]++;
+        }
+        engine->wagons[p] = ENGINE_START_WAGONS;
+    }
+    refillFaceUp(engine);
+    
+    memcpy(engine->ticketPile, map->tickets, sizeof(Objective) * map->nbTickets);
+    engine->ticketPileSize = map->nbTickets;
+    for (int i = engine->ticketPileSize - 1; i > 0; i--) {
+        int j = randomBelow(&engine->rng, i + 1);
+        Objective tmp = engine->ticketPile[i];
+        engine->ticketPile[i] = engine->ticketPile[j];
+        engine->ticketPile[j] = tmp;
+    }
+    
+    engine->current = starter % ENGINE_PLAYERS;
+    engine->finalTurns = -1;
+}
+
+// Starts the player with these tickets, taken out of the pile
+void giveEngineTickets(Engine* engine, int player, const Objective* tickets, int nbTickets) {
+    for (int t = 0; t < nbTickets && engine->nbObjectives[player] < MAX_OBJECTIVES; t++) {
+        engine->objectives[player][engine->nbObjectives[player]++] = tickets[t];
+        for (int i = 0; i < engine->ticketPileSize; i++) {
+            if (engine->ticketPile[i].from == tickets[t].from && engine->ticketPile[i].to == tickets[t].to) {
+                memmove(engine->ticketPile + i, engine->ticketPile + i + 1, sizeof(Objective) * (engine->ticketPileSize - i - 1));
+                engine->ticketPileSize--;
+                break;
+            }
+        }
+    }
+}
+
+static void endTurn(Engine* engine) {
+    engine->cardsThisTurn = 0;
+    engine->turns++;
+    engine->current = (engine->current + 1) % ENGINE_PLAYERS;
+    
+    if (engine->finalTurns > 0 && --engine->finalTurns == 0) {
+        engine->over = 1;
+    }
+    if (engine->turns >= ENGINE_MAX_TURNS) {
+        engine->over = 1;
+    }
+}
+
+// Whether the free track i can be paid with this colour and locomotive count
+static int canPayTrack(const Engine* engine, int player, int i, int color, int locomotives) {
+    const int* track = &engine->map->trackData[i * 5];
+    int length = track[2];
+    
+    if (engine->routeOwner[i] >= 0 || length > engine->wagons[player] || locomotives < 0 || locomotives > length) {
+        return 0;
+    }
+    
+    if (color == LOCOMOTIVE) {
+        return engine->hand[player][LOCOMOTIVE] >= length;
+    }
+    
+    int colorOk = track[3] == LOCOMOTIVE || track[3] == color || track[4] == color;
+    return colorOk && engine->hand[player][color] >= length - locomotives &&
+           engine->hand[player][LOCOMOTIVE] >= locomotives;
+}
+
+// Free route between the move's cities the player can pay as announced, -1 if none
+int engineRouteIndex(const Engine* engine, int player, const MoveData* move) {
+    const EngineMap* map = engine->map;
+    int from = move->claimRoute.from;
+    int to = move->claimRoute.to;
+    int color = move->claimRoute.color;
+    
+    if (color < PURPLE || color > LOCOMOTIVE) {
+        return -1;
+    }
+    
+    for (int i = 0; i < map->nbTracks; i++) {
+        const int* track = &map->trackData[i * 5];
+        if (((track[0] == from && track[1] == to) || (track[0] == to && track[1] == from)) &&
+            canPayTrack(engine, player, i, color, move->claimRoute.nbLocomotives)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static MoveState claimRoute(Engine* engine, int player, const MoveData* move) {
+    if (engine->cardsThisTurn > 0) {
+        return ILLEGAL_MOVE;
+    }
+    
+    int routeIndex = engineRouteIndex(engine, player, move);
+    if (routeIndex < 0) {
+        return ILLEGAL_MOVE;
+    }
+    
+    int length = engine->map->trackData[routeIndex * 5 + 2];
+    int color = move->claimRoute.color;
+    int locomotives = color == LOCOMOTIVE ? length : (int)move->claimRoute.nbLocomotives;
+    
+    engine->hand[player][color] -= length - locomotives;
+    engine->hand[player][LOCOMOTIVE] -= locomotives;
+    for (int k = 0; k < length; k++) {
+        engine->discard[engine->discardSize++] = k < locomotives ? LOCOMOTIVE : color;
+    }
+    
+    engine->routeOwner[routeIndex] = player;
+    engine->wagons[player] -= length;
+    engine->routePoints[player] += routePointsForLength(length);
+    
+    // Everyone, the trigger included, gets one last turn
+    if (engine->wagons[player] <= 2 && engine->finalTurns < 0) {
+        engine->finalTurns = ENGINE_PLAYERS + 1;
+    }
+    
+    endTurn(engine);
+    return NORMAL_MOVE;
+}
+
+static MoveState drawCard(Engine* engine, int player, const MoveData* move, MoveResult* result) {
+    CardColor card;
+    
+    if (move->action == DRAW_BLIND_CARD) {
+        card = drawFromDeck(engine);
+        if (card == NONE) {
+            return ILLEGAL_MOVE;
+        }
+    } else {
+        int slot = -1;
+        for (int i = 0; i < 5 && slot < 0; i++) {
+            if (engine->faceUp[i] == move->drawCard && move->drawCard != NONE) slot = i;
+        }
+        if (slot < 0 || (move->drawCard == LOCOMOTIVE && engine->cardsThisTurn > 0)) {
+            return ILLEGAL_MOVE;
+        }
+        
+        card = engine->faceUp[slot];
+        engine->faceUp[slot] = NONE;
+        refillFaceUp(engine);
+    }
+    
+    engine->hand[player][card]++;
+    result->card = card;
+    
+    int turnOver = ++engine->cardsThisTurn >= 2 || cardsLeft(engine) == 0 ||
+                   (move->action == DRAW_CARD && card == LOCOMOTIVE);
+    if (turnOver) {
+        endTurn(engine);
+    } else {
+        result->replay = true;
+    }
+    return NORMAL_MOVE;
+}
+
+static MoveState drawObjectives(Engine* engine, int player, MoveResult* result) {
+    if (engine->cardsThisTurn > 0 || engine->ticketPileSize == 0) {
+        return ILLEGAL_MOVE;
+    }
+    
+    int count = engine->ticketPileSize < 3 ? engine->ticketPileSize : 3;
+    for (int i = 0; i < count; i++) {
+        engine->offered[player][i] = engine->ticketPile[--engine->ticketPileSize];
+        result->objectives[i] = engine->offered[player][i];
+    }
+    engine->nbOffered[player] = count;
+    result->replay = true;
+    return NORMAL_MOVE;
+}
+
+static MoveState chooseObjectives(Engine* engine, int player, const MoveData* move) {
+    int kept = 0;
+    for (int i = 0; i < engine->nbOffered[player]; i++) {
+        if (move->chooseObjectives[i]) kept++;
+    }
+    if (kept == 0) {
+        return ILLEGAL_MOVE;
+    }
+    
+    // Returned tickets go under the pile
+    Objective returned[3];
+    int nbReturned = 0;
+    for (int i = 0; i < engine->nbOffered[player]; i++) {
+        if (move->chooseObjectives[i] && engine->nbObjectives[player] < MAX_OBJECTIVES) {
+            engine->objectives[player][engine->nbObjectives[player]++] = engine->offered[player][i];
+        } else {
+            returned[nbReturned++] = engine->offered[player][i];
+        }
+    }
+    memmove(engine->ticketPile + nbReturned, engine->ticketPile, sizeof(Objective) * engine->ticketPileSize);
+    memcpy(engine->ticketPile, returned, sizeof(Objective) * nbReturned);
+    engine->ticketPileSize += nbReturned;
+    
+    engine->nbOffered[player] = 0;
+    endTurn(engine);
+    return NORMAL_MOVE;
+}
+
+MoveState playEngineMove(Engine* engine, int player, const MoveData* move, MoveResult* result) {
+    memset(result, 0, sizeof(MoveResult));
+    result->state = ILLEGAL_MOVE;
+    
+    if (engine->over || player != engine->current) {
+        return ILLEGAL_MOVE;
+    }
+    
+    // Offered tickets must be answered before anything else
+    if (engine->nbOffered[player] > 0 && move->action != CHOOSE_OBJECTIVES) {
+        return ILLEGAL_MOVE;
+    }
+    
+    MoveState state;
+    switch (move->action) {
+        case CLAIM_ROUTE:
+            state = claimRoute(engine, player, move);
+            break;
+        case DRAW_CARD:
+        case DRAW_BLIND_CARD:
+            state = drawCard(engine, player, move, result);
+            break;
+        case DRAW_OBJECTIVES:
+            state = drawObjectives(engine, player, result);
+            break;
+        case CHOOSE_OBJECTIVES:
+            state = engine->nbOffered[player] > 0 ? chooseObjectives(engine, player, move) : ILLEGAL_MOVE;
+            break;
+        default:
+            state = ILLEGAL_MOVE;
+            break;
+    }
+    
+    if (state == NORMAL_MOVE && engine->over) {
+        EngineScore scores[ENGINE_PLAYERS];
+        scoreEngineGame(engine, scores);
+        state = scores[player].total >= scores[1 - player].total ? WINNING_MOVE : LOOSING_MOVE;
+    }
+    
+    result->state = state;
+    return state;
+}
+
+// Fills move with a claim of routeIndex the player can pay, 0 if it cannot
+static int scriptedClaim(const Engine* engine, int player, int routeIndex, MoveData* move) {
+    const int* track = &engine->map->trackData[routeIndex * 5];
+    const int* hand = engine->hand[player];
+    int length = track[2];
+    
+    for (int color = PURPLE; color <= LOCOMOTIVE; color++) {
+        int colorOk = color == LOCOMOTIVE || track[3] == LOCOMOTIVE || track[3] == color || track[4] == color;
+        if (!colorOk) {
+            continue;
+        }
+        
+        int locomotives = color == LOCOMOTIVE ? length : (hand[color] >= length ? 0 : length - hand[color]);
+        move->action = CLAIM_ROUTE;
+        move->claimRoute.from = track[0];
+        move->claimRoute.to = track[1];
+        move->claimRoute.color = color;
+        move->claimRoute.nbLocomotives = locomotives;
+        if (canPayTrack(engine, player, routeIndex, color, locomotives)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+typedef struct {
+    int start[MAX_CITIES + 1];
+    int tracks[MAX_ROUTES * 2];
+} TrackIncidence;
+
+// Tracks touching each city, the ones the player can still use only
+static void buildIncidence(const Engine* engine, int player, TrackIncidence* incidence) {
+    const EngineMap* map = engine->map;
+    int degree[MAX_CITIES + 1] = {0};
+    
+    for (int i = 0; i < map->nbTracks; i++) {
+        if (engine->routeOwner[i] < 0 || engine->routeOwner[i] == player) {
+            degree[map->trackData[i * 5]]++;
+            degree[map->trackData[i * 5 + 1]]++;
+        }
+    }
+    incidence->start[0] = 0;
+    for (int c = 0; c < map->nbCities; c++) {
+        incidence->start[c + 1] = incidence->start[c] + degree[c];
+        degree[c] = incidence->start[c];
+    }
+    for (int i = 0; i < map->nbTracks; i++) {
+        if (engine->routeOwner[i] < 0 || engine->routeOwner[i] == player) {
+            incidence->tracks[degree[map->trackData[i * 5]]++] = i;
+            incidence->tracks[degree[map->trackData[i * 5 + 1]]++] = i;
+        }
+    }
+}
+
+// Wagons still to lay from start, the player's routes free and the other player's closed
+static void ticketDistances(const Engine* engine, const TrackIncidence* incidence, int player, int start,
+                            int* dist, int* prevTrack) {
+    const EngineMap* map = engine->map;
+    int visited[MAX_CITIES] = {0};
+    
+    for (int c = 0; c < map->nbCities; c++) {
+        dist[c] = ENGINE_NO_PATH;
+        prevTrack[c] = -1;
+    }
+    dist[start] = 0;
+    
+    for (int count = 0; count < map->nbCities; count++) {
+        int u = -1;
+        for (int c = 0; c < map->nbCities; c++) {
+            if (!visited[c] && dist[c] < ENGINE_NO_PATH && (u < 0 || dist[c] < dist[u])) {
+                u = c;
+            }
+        }
+        if (u < 0) break;
+        visited[u] = 1;
+        
+        for (int k = incidence->start[u]; k < incidence->start[u + 1]; k++) {
+            int i = incidence->tracks[k];
+            const int* track = &map->trackData[i * 5];
+            int v = track[0] == u ? track[1] : track[0];
+            int length = engine->routeOwner[i] == player ? 0 : track[2];
+            if (dist[u] + length < dist[v]) {
+                dist[v] = dist[u] + length;
+                prevTrack[v] = i;
+            }
+        }
+    }
+}
+
+// Claim on the cheapest unlinked ticket's path, else the colour that path needs (NONE when no ticket is left)
+static int ticketMove(const Engine* engine, int player, MoveData* move, int* wanted) {
+    const EngineMap* map = engine->map;
+    int dist[MAX_CITIES];
+    int prevTrack[MAX_CITIES];
+    int bestPrev[MAX_CITIES];
+    int bestCost = ENGINE_NO_PATH;
+    int bestObjective = -1;
+    *wanted = NONE;
+    
+    TrackIncidence incidence;
+    buildIncidence(engine, player, &incidence);
+    
+    for (int i = 0; i < engine->nbObjectives[player]; i++) {
+        const Objective* objective = &engine->objectives[player][i];
+        ticketDistances(engine, &incidence, player, objective->from, dist, prevTrack);
+        
+        int cost = dist[objective->to];
+        if (cost > 0 && cost <= engine->wagons[player] && cost < bestCost) {
+            bestCost = cost;
+            bestObjective = i;
+            memcpy(bestPrev, prevTrack, sizeof(int) * map->nbCities);
+        }
+    }
+    if (bestObjective < 0) {
+        return 0;
+    }
+    
+    const Objective* objective = &engine->objectives[player][bestObjective];
+    for (int city = objective->to; city != (int)objective->from && bestPrev[city] >= 0; ) {
+        int i = bestPrev[city];
+        const int* track = &map->trackData[i * 5];
+        city = track[0] == city ? track[1] : track[0];
+        if (engine->routeOwner[i] >= 0) continue;
+        
+        if (engine->cardsThisTurn == 0 && scriptedClaim(engine, player, i, move)) {
+            return 1;
+        }
+        if (*wanted == NONE || *wanted == LOCOMOTIVE) {
+            *wanted = track[3];
+        }
+    }
+    memset(move, 0, sizeof(MoveData));
+    return 0;
+}
+
+// Greedy takes the longest route it can afford, random a third of the time any route;
+// tickets plays like greedy once its tickets are linked or out of reach
+void scriptedMove(const Engine* engine, int player, ScriptKind kind, EngineRng* rng, MoveData* move) {
+    memset(move, 0, sizeof(MoveData));
+    
+    if (engine->nbOffered[player] > 0) {
+        move->action = CHOOSE_OBJECTIVES;
+        for (int i = 0; i < engine->nbOffered[player]; i++) {
+            move->chooseObjectives[i] = kind != SCRIPT_RANDOM ? i == 0 : randomBelow(rng, 2);
+        }
+        move->chooseObjectives[randomBelow(rng, engine->nbOffered[player])] = true;
+        return;
+    }
+    
+    if (engine->nbObjectives[player] == 0 && engine->cardsThisTurn == 0) {
+        move->action = DRAW_OBJECTIVES;
+        return;
+    }
+    
+    int wanted = NONE;
+    if (kind == SCRIPT_TICKETS && ticketMove(engine, player, move, &wanted)) {
+        return;
+    }
+    
+    if (engine->cardsThisTurn == 0 && wanted == NONE) {
+        int best = -1;
+        int bestLength = 0;
+        for (int i = 0; i < engine->map->nbTracks; i++) {
+            MoveData claim;
+            int length = engine->map->trackData[i * 5 + 2];
+            if (length > bestLength && scriptedClaim(engine, player, i, &claim)) {
+                best = i;
+                bestLength = length;
+                *move = claim;
+                if (kind == SCRIPT_RANDOM && randomBelow(rng, 3) == 0) break;
+            }
+        }
+        if (best >= 0 && (kind != SCRIPT_RANDOM || randomBelow(rng, 3) == 0)) {
+            return;
+        }
+        memset(move, 0, sizeof(MoveData));
+    }
+    
+    int bestColor = NONE;
+    if (wanted != NONE) {
+        // A grey route takes any colour, so only a coloured one is worth a face-up card
+        for (int i = 0; i < 5; i++) {
+            if (wanted != LOCOMOTIVE && engine->faceUp[i] == (CardColor)wanted) {
+                bestColor = wanted;
+            }
+        }
+    } else if (kind != SCRIPT_RANDOM) {
+        for (int i = 0; i < 5; i++) {
+            CardColor card = engine->faceUp[i];
+            if (card != NONE && card != LOCOMOTIVE &&
+                (bestColor == NONE || engine->hand[player][card] > engine->hand[player][bestColor])) {
+                bestColor = card;
+            }
+        }
+    } else {
+        CardColor card = engine->faceUp[randomBelow(rng, 5)];
+        bestColor = (card != LOCOMOTIVE && randomBelow(rng, 2)) ? card : NONE;
+    }
+    
+    if (bestColor != NONE) {
+        move->action = DRAW_CARD;
+        move->drawCard = bestColor;
+    } else {
+        move->action = DRAW_BLIND_CARD;
+    }
+}
+
+static int findRoot(int* parent, int x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+static int longestTrail(const Engine* engine, int player, int city, unsigned char* used) {
+    const EngineMap* map = engine->map;
+    int best = 0;
+    
+    for (int i = 0; i < map->nbTracks; i++) {
+        const int* track = &map->trackData[i * 5];
+        if (used[i] || engine->routeOwner[i] != player || (track[0] != city && track[1] != city)) {
+            continue;
+        }
+        
+        used[i] = 1;
+        int next = track[0] == city ? track[1] : track[0];
+        int length = track[2] + longestTrail(engine, player, next, used);
+        used[i] = 0;
+        
+        if (length > best) best = length;
+    }
+    return best;
+}
+
+void scoreEngineGame(const Engine* engine, EngineScore* scores) {
+    const EngineMap* map = engine->map;
+    int bestPath = 0;
+    
+    for (int p = 0; p < ENGINE_PLAYERS; p++) {
+        EngineScore* score = &scores[p];
+        memset(score, 0, sizeof(EngineScore));
+        score->routePoints = engine->routePoints[p];
+        score->wagonsLeft = engine->wagons[p];
+        
+        int parent[MAX_CITIES];
+        for (int c = 0; c < map->nbCities; c++) {
+            parent[c] = c;
+        }
+        for (int i = 0; i < map->nbTracks; i++) {
+            if (engine->routeOwner[i] == p) {
+                parent[findRoot(parent, map->trackData[i * 5])] = findRoot(parent, map->trackData[i * 5 + 1]);
+            }
+        }
+        
+        for (int i = 0; i < engine->nbObjectives[p]; i++) {
+            const Objective* objective = &engine->objectives[p][i];
+            if (findRoot(parent, objective->from) == findRoot(parent, objective->to)) {
+                score->objectivePoints += objective->score;
+                score->objectivesCompleted++;
+                score->completedMask |= 1 << i;
+            } else {
+                score->objectivePoints -= objective->score;
+            }
+        }
+        
+        unsigned char used[MAX_ROUTES] = {0};
+        for (int c = 0; c < map->nbCities; c++) {
+            int length = longestTrail(engine, p, c, used);
+            if (length > score->longestPath) score->longestPath = length;
+        }
+        if (score->longestPath > bestPath) bestPath = score->longestPath;
+    }
+    
+    for (int p = 0; p < ENGINE_PLAYERS; p++) {
+        EngineScore* score = &scores[p];
+        score->longestBonus = (bestPath > 0 && score->longestPath == bestPath) ? ENGINE_LONGEST_BONUS : 0;
+        score->total = score->routePoints + score->objectivePoints + score->longestBonus;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+#include <stdint.h>
+#include "gamestate.h"
+#include "../tickettorideapi/ticketToRide.h"
+
+// In-process rules engine: the referee for self-play and the local server
+#define ENGINE_PLAYERS 2
+#define ENGINE_START_WAGONS 45
+#define ENGINE_DECK_SIZE 110       // 12 of each colour, 14 locomotives
+#define ENGINE_MAX_TICKETS 64
+#define ENGINE_LONGEST_BONUS 10
+#define ENGINE_MAX_TURNS 500
+
+typedef struct {
+    uint64_t state;
+} EngineRng;
+
+typedef struct {
+    int nbCities;
+    int nbTracks;
+    int trackData[MAX_ROUTES * 5];   // same layout as GameData
+    Objective tickets[ENGINE_MAX_TICKETS];
+    int nbTickets;
+} EngineMap;
+
+typedef struct {
+    const EngineMap* map;
+    int routeOwner[MAX_ROUTES];      // -1 free, else player
+    
+    CardColor deck[ENGINE_DECK_SIZE];
+    int deckSize;
+    CardColor discard[ENGINE_DECK_SIZE];
+    int discardSize;
+    CardColor faceUp[5];             // NONE once the deck runs dry
+    
+    Objective ticketPile[ENGINE_MAX_TICKETS];
+    int ticketPileSize;
+    
+    int hand[ENGINE_PLAYERS][10];
+    CardColor startCards[ENGINE_PLAYERS][4];
+    int wagons[ENGINE_PLAYERS];
+    int routePoints[ENGINE_PLAYERS];
+    Objective objectives[ENGINE_PLAYERS][MAX_OBJECTIVES];
+    int nbObjectives[ENGINE_PLAYERS];
+    Objective offered[ENGINE_PLAYERS][3];
+    int nbOffered[ENGINE_PLAYERS];
+    
+    int current;                     // player to move
+    int cardsThisTurn;               // cards already drawn this turn
+    int finalTurns;                  // turns left once someone is down to 2 wagons, -1 before
+    int turns;
+    int over;
+    
+    EngineRng rng;
+} Engine;
+
+typedef enum {
+    SCRIPT_RANDOM,
+    SCRIPT_GREEDY,
+    SCRIPT_TICKETS   // builds its tickets' cheapest paths, greedy once they are done
+} ScriptKind;
+
+typedef struct {
+    int total;
+    int routePoints;
+    int objectivePoints;
+    int objectivesCompleted;
+    int completedMask;   // bit i set when objective i is linked
+    int longestPath;
+    int longestBonus;
+    int wagonsLeft;
+} EngineScore;
+
+void seedRng(EngineRng* rng, uint64_t seed);
+uint64_t nextRandom(EngineRng* rng);
+int randomBelow(EngineRng* rng, int n);
+
+void generateEngineMap(EngineMap* map, EngineRng* rng, int nbCities, int nbTracks, int nbTickets);
+int loadEngineMap(EngineMap* map, const char* path);
+void mapGameData(const EngineMap* map, GameData* gameData);
+
+void startEngineGame(Engine* engine, const EngineMap* map, uint64_t seed, int starter);
+void giveEngineTickets(Engine* engine, int player, const Objective* tickets, int nbTickets);
+MoveState playEngineMove(Engine* engine, int player, const MoveData* move, MoveResult* result);
+int engineRouteIndex(const Engine* engine, int player, const MoveData* move);
+void scoreEngineGame(const Engine* engine, EngineScore* scores);
+void scriptedMove(const Engine* engine, int player, ScriptKind kind, EngineRng* rng, MoveData* move);
+
+#endif
\ No newline at end of file
@@ -3,6 +3,22 @@
 #include <string.h>
 #include "gamestate.h"
 #include "rules.h"
+#include "opponent.h"
+#include "contention.h"
+#include "chokepoints.h"
+#include "reachability.h"
+#include "topology.h"
+#include "segments.h"
+#include "hierarchy.h"
+#include "book.h"
+
+// Incremental planners replay this log instead of searching from scratch
+static void recordOwnerChange(GameState* state, int routeIndex) {
+    state->ownershipVersion++;
+    if (state->nbRouteChanges < MAX_ROUTES * 2) {
+        state->routeChangeLog[state->nbRouteChanges++] = routeIndex;
+    }
+}
 
 void initGameState(GameState* state, GameData* gameData) {
     memset(state, 0, sizeof(GameState));
@@ -19,9 +35,7 @@ void initGameState(GameState* state, GameData* gameData) {
     state->turnCount = 0;
     
     for (int i = 0; i < MAX_CITIES; i++) {
-        for (int j = 0; j < MAX_CITIES; j++) {
-            state->cityConnected[i][j] = 0;
-        }
+        state->cityLink[i] = i;
     }
     
     int* trackData = gameData->trackData;
@@ -43,6 +57,16 @@ void initGameState(GameState* state, GameData* gameData) {
     }
     
     memset(state->visibleCards, 0, sizeof(state->visibleCards));
+    
+    initOpponentModel(state);
+    initContention(state);
+    initChokepoints(state);
+    initReachability(state);
+    initTopology(state);
+    initSegments(state);
+    initHierarchy(state);
+    
+    state->mapHash = computeMapHash(state);
 }
 
 void addCardToHand(GameState* state, CardColor card) {
@@ -71,6 +95,9 @@ void removeCardsForRoute(GameState* state, CardColor color, int length, int nbLo
     state->nbCardsByColor[LOCOMOTIVE] -= nbLocomotives;
     state->nbCards -= length;
     
+    state->discardedCards[color] += (length - nbLocomotives);
+    state->discardedCards[LOCOMOTIVE] += nbLocomotives;
+    
     if (state->nbCardsByColor[color] < 0) {
         state->nbCardsByColor[color] = 0;
     }
@@ -104,11 +131,24 @@ void addClaimedRoute(GameState* state, int from, int to) {
         }
         
         state->routes[routeIndex].owner = 1;
+        recordOwnerChange(state, routeIndex);
+        chokepointsRouteChanged(state, routeIndex);
         if (state->nbClaimedRoutes < MAX_ROUTES) {
             state->claimedRoutes[state->nbClaimedRoutes++] = routeIndex;
         }
         
-        updateCityConnectivity(state);
+        linkCities(state, from, to);
+    }
+}
+
+// Fresh board from the server; an empty slot may be refilled without notice
+void setVisibleCards(GameState* state, const CardColor* cards) {
+    state->visibleCardsKnown = 1;
+    for (int i = 0; i < 5; i++) {
+        state->visibleCards[i] = cards[i];
+        if (cards[i] == NONE) {
+            state->visibleCardsKnown = 0;
+        }
     }
 }
 
@@ -134,7 +174,19 @@ void updateAfterOpponentMove(GameState* state, MoveData* moveData) {
                 
                 if (routeIndex != -1) {
                     state->routes[routeIndex].owner = 2;
+                    recordOwnerChange(state, routeIndex);
+                    chokepointsRouteChanged(state, routeIndex);
+                    reachabilityRouteLost(state, routeIndex);
                     state->opponentWagonsLeft -= state->routes[routeIndex].length;
+                    state->opponentCardCount -= state->routes[routeIndex].length;
+                    if (state->opponentCardCount < 0) {
+                        state->opponentCardCount = 0;
+                    }
+                    
+                    opponentUsedCards(state, moveData->claimRoute.color,
+                                      state->routes[routeIndex].length,
+                                      moveData->claimRoute.nbLocomotives);
+                    contentionAfterOpponentMove(state, moveData, routeIndex);
                     
                     if (state->opponentWagonsLeft <= 2) {
                         state->lastTurn = 1;
@@ -144,8 +196,15 @@ void updateAfterOpponentMove(GameState* state, MoveData* moveData) {
             break;
             
         case DRAW_CARD:
+            state->opponentCardCount++;
+            state->visibleCardsKnown = 0;
+            opponentDrewVisibleCard(state, moveData->drawCard);
+            contentionAfterOpponentMove(state, moveData, -1);
+            break;
+            
         case DRAW_BLIND_CARD:
             state->opponentCardCount++;
+            opponentDrewBlindCard(state);
             break;
             
         case CHOOSE_OBJECTIVES:
@@ -168,56 +227,12 @@ void updateAfterOpponentMove(GameState* state, MoveData* moveData) {
     }
 }
 
-void updateCityConnectivity(GameState* state) {
-    if (!state) {
-        return;
-    }
-    
-    if (state->nbCities <= 0 || state->nbCities > MAX_CITIES) {
-        return;
-    }
-    
-    for (int i = 0; i < state->nbCities; i++) {
-        for (int j = 0; j < state->nbCities; j++) {
-            state->cityConnected[i][j] = 0;
-        }
-    }
-    
-    // Add direct connections from our routes
-    for (int i = 0; i < state->nbClaimedRoutes; i++) {
-        int routeIndex = state->claimedRoutes[i];
-        
-        if (routeIndex < 0 || routeIndex >= state->nbTracks) {
-            continue;
-        }
-        
-        int from = state->routes[routeIndex].from;
-        int to = state->routes[routeIndex].to;
-        
-        if (from < 0 || from >= state->nbCities || to < 0 || to >= state->nbCities) {
-            continue;
-        }
-        
-        state->cityConnected[from][to] = 1;
-        state->cityConnected[to][from] = 1;
-    }
-    
-    // Floyd-Warshall to find all connections
-    for (int k = 0; k < state->nbCities; k++) {
-        for (int i = 0; i < state->nbCities; i++) {
-            for (int j = 0; j < state->nbCities; j++) {
-                if (state->cityConnected[i][k] && state->cityConnected[k][j]) {
-                    state->cityConnected[i][j] = 1;
-                }
-            }
-        }
-    }
-}
-
 void addObjectives(GameState* state, Objective* objectives, int count) {
     for (int i = 0; i < count && state->nbObjectives < MAX_OBJECTIVES; i++) {
         state->objectives[state->nbObjectives++] = objectives[i];
     }
+    
+    chokepointsObjectivesChanged(state);
 }
 
 void analyzeExistingNetwork(GameState* state, int* cityConnectivity) {
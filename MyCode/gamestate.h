@@ -1,11 +1,23 @@
 #ifndef GAMESTATE_H
 #define GAMESTATE_H
+#include <stdint.h>
 #include "../tickettorideapi/ticketToRide.h"
 
 #define MAX_CARDS 100
 #define MAX_OBJECTIVES 15
+// Map limits, can be raised from the compiler command line for larger maps
+#ifndef MAX_ROUTES
 #define MAX_ROUTES 150
+#endif
+#ifndef MAX_CITIES
 #define MAX_CITIES 50
+#endif
+#ifndef MAX_CH_ARCS
+#define MAX_CH_ARCS (MAX_ROUTES * 8)
+#endif
+#define MAX_REGIONS 8
+#define MAX_HUBS 5
+#define OPENING_CLAIMS 4
 
 typedef struct {
     int from;
@@ -16,6 +28,16 @@ typedef struct {
     int owner; // 0=libre, 1=nous, 2=adversaire
 } Route;
 
+// LPA* search state for one objective, repaired from the owner change log
+typedef struct {
+    int valid;
+    int start;
+    int goal;
+    int syncedChanges;  // owner change log entries already applied
+    int g[MAX_CITIES];
+    int rhs[MAX_CITIES];
+} ObjectivePlanner;
+
 typedef struct {
     int nbCities;
     int nbTracks;
@@ -29,11 +51,12 @@ typedef struct {
     int nbObjectives;
     
     CardColor visibleCards[5];
+    int visibleCardsKnown;  // 0 once a face-up pick refilled a slot we have not seen
     
     int claimedRoutes[MAX_ROUTES];
     int nbClaimedRoutes;
     
-    int cityConnected[MAX_CITIES][MAX_CITIES];
+    int cityLink[MAX_CITIES];  // union-find over our routes, linked cities share a root
     
     int lastTurn;
     int wagonsLeft;
@@ -42,6 +65,73 @@ typedef struct {
     int opponentWagonsLeft;
     int opponentCardCount;
     int opponentObjectiveCount;
+    
+    int opponentKnownCards[10];      // seen face-up picks, certain
+    float opponentUnknownCards[10];  // expected colours of blind draws
+    int opponentUnknownCount;
+    int discardedCards[10];
+    
+    int ownershipVersion;  // bumped on every route owner change
+    int routeChangeLog[MAX_ROUTES * 2];
+    int nbRouteChanges;
+    
+    float routeThreat[MAX_ROUTES];
+    int opponentCities[MAX_CITIES];
+    float routeScarcity[MAX_ROUTES];
+    int scarcityVersion;
+    
+    unsigned char routeChokepoint[MAX_ROUTES];     // worst flag over the open objectives
+    unsigned char cityArticulation[MAX_CITIES];
+    unsigned char chokeRegion[MAX_CITIES];
+    int chokepointDirty;
+    unsigned char objectiveChokeRegion[MAX_OBJECTIVES][MAX_CITIES];  // per objective, region and articulation bits
+    unsigned char objectiveChokepoints[MAX_OBJECTIVES][MAX_ROUTES];
+    unsigned char objectiveChokeDirty[MAX_OBJECTIVES];
+    int chokeObjectivesSeen;
+    
+    int cityComponent[MAX_CITIES];  // components of the non-opponent graph
+    int nextComponentId;
+    
+    int networkReach[MAX_CITIES];  // wagons to link each city to our network
+    int pairsWithinReach[64];      // city pairs linkable for <= n wagons
+    int committedWagons;           // still needed by open objectives
+    int drawValueVersion;
+    int drawValueObjectives;
+    
+    int cityDistance[MAX_CITIES][MAX_CITIES];  // empty-board shortest paths, -1 if unreachable
+    float cityBetweenness[MAX_CITIES];
+    float cityConnectionCost[MAX_CITIES];      // mean distance to the other cities
+    float mapConnectionCost;
+    int cityRegion[MAX_CITIES];
+    float regionConnectionCost[MAX_REGIONS];
+    int nbRegions;
+    int hubCities[MAX_HUBS];                   // highest betweenness first
+    int nbHubs;
+    int incidentRoutes[MAX_ROUTES * 2];        // routes touching each city, by incidentStart
+    int incidentStart[MAX_CITIES + 1];
+    
+    ObjectivePlanner planners[MAX_OBJECTIVES];
+    
+    uint16_t missingSegments[MAX_CITIES][MAX_CITIES];  // free routes to claim between two cities
+    int ownedComponent[MAX_CITIES];
+    int segmentsVersion;                       // -1 while missingSegments is not valid
+    
+    int chRank[MAX_CITIES];                // contraction order
+    int chParent[MAX_CITIES];              // elimination tree
+    int chUpStart[MAX_CITIES + 1];
+    int chUpTarget[MAX_CH_ARCS];           // upward arcs, routes and shortcuts
+    int chDownStart[MAX_CITIES + 1];
+    int chDownSource[MAX_CH_ARCS];
+    int chWeight[MAX_CH_ARCS];             // customized for the current owners
+    int chBaseWeight[MAX_CH_ARCS];         // cheapest original route, CH_INF for pure shortcuts
+    int chRouteArc[MAX_ROUTES];
+    int chNbArcs;
+    int chReady;
+    int chVersion;
+    
+    unsigned long long mapHash;            // identifies the map for the opening book
+    int openingClaims[OPENING_CLAIMS];     // book line still to play, in order
+    int nbOpeningClaims;
 } GameState;
 
 void initGameState(GameState* state, GameData* gameData);
@@ -49,8 +139,8 @@ void addCardToHand(GameState* state, CardColor card);
 void removeCardsForRoute(GameState* state, CardColor color, int length, int nbLocomotives);
 void addClaimedRoute(GameState* state, int from, int to);
 void updateAfterOpponentMove(GameState* state, MoveData* moveData);
-void updateCityConnectivity(GameState* state);
 void addObjectives(GameState* state, Objective* objectives, int count);
+void setVisibleCards(GameState* state, const CardColor* cards);
 void printGameState(GameState* state);
 void analyzeExistingNetwork(GameState* state, int* cityConnectivity);
 
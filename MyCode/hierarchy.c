@@ -0,0 +1,390 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "hierarchy.h"
+
+// Customizable contraction hierarchy: the order and the shortcuts only
+// depend on the map; weights are re-customized when an owner changes.
+#define CH_INF (1 << 29)
+
+static int arcWeightOfRoute(GameState* state, int routeIndex) {
+    if (state->routes[routeIndex].owner == 2) return CH_INF;
+    if (state->routes[routeIndex].owner == 1) return 0;
+    return state->routes[routeIndex].length;
+}
+
+// Arc from lower to higher ranked city, -1 if the pair has none
+static int findArc(GameState* state, int a, int b) {
+    int low = (state->chRank[a] < state->chRank[b]) ? a : b;
+    int high = (low == a) ? b : a;
+    
+    int lo = state->chUpStart[low];
+    int hi = state->chUpStart[low + 1] - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if (state->chUpTarget[mid] == high) return mid;
+        if (state->chUpTarget[mid] < high) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return -1;
+}
+
+static int compareInts(const void* a, const void* b) {
+    return *(const int*)a - *(const int*)b;
+}
+
+// Min-degree elimination, every fill-in edge kept as a shortcut
+static int contractGraph(GameState* state) {
+    int n = state->nbCities;
+    int words = (n + 63) / 64;
+    uint64_t* adjacency = calloc((size_t)n * words, sizeof(uint64_t));
+    int* degree = calloc(n, sizeof(int));
+    int* eliminated = calloc(n, sizeof(int));
+    int* upCount = calloc(n + 1, sizeof(int));
+    int* arcSource = malloc(sizeof(int) * MAX_CH_ARCS);
+    int* arcTarget = malloc(sizeof(int) * MAX_CH_ARCS);
+    int nbArcs = 0;
+    int ok = adjacency && degree && eliminated && upCount && arcSource && arcTarget;
+    
+    #define ADJ(u, v) (adjacency[(size_t)(u) * words + (v) / 64] & (1ULL << ((v) % 64)))
+    #define SET_ADJ(u, v) (adjacency[(size_t)(u) * words + (v) / 64] |= (1ULL << ((v) % 64)))
+    #define CLEAR_ADJ(u, v) (adjacency[(size_t)(u) * words + (v) / 64] &= ~(1ULL << ((v) % 64)))
+    
+    for (int r = 0; ok && r < state->nbTracks; r++) {
+        int a = state->routes[r].from;
+        int b = state->routes[r].to;
+        if (a == b || a < 0 || b < 0 || a >= n || b >= n || ADJ(a, b)) continue;
+        SET_ADJ(a, b);
+        SET_ADJ(b, a);
+        degree[a]++;
+        degree[b]++;
+    }
+    
+    int* neighbours = ok ? malloc(sizeof(int) * n) : NULL;
+    ok = ok && neighbours;
+    
+    for (int k = 0; ok && k < n; k++) {
+        int v = -1;
+        for (int c = 0; c < n; c++) {
+            if (!eliminated[c] && (v < 0 || degree[c] < degree[v])) v = c;
+        }
+        
+        state->chRank[v] = k;
+        eliminated[v] = 1;
+        
+        int nbNeighbours = 0;
+        for (int c = 0; c < n; c++) {
+            if (!eliminated[c] && ADJ(v, c)) neighbours[nbNeighbours++] = c;
+        }
+        
+        if (nbArcs + nbNeighbours > MAX_CH_ARCS) {
+            ok = 0;
+            break;
+        }
+        
+        for (int i = 0; i < nbNeighbours; i++) {
+            int u = neighbours[i];
+            arcSource[nbArcs] = v;
+            arcTarget[nbArcs] = u;
+            nbArcs++;
+            upCount[v]++;
+            
+            CLEAR_ADJ(u, v);
+            degree[u]--;
+            
+            for (int j = i + 1; j < nbNeighbours; j++) {
+                int w = neighbours[j];
+                if (!ADJ(u, w)) {
+                    SET_ADJ(u, w);
+                    SET_ADJ(w, u);
+                    degree[u]++;
+                    degree[w]++;
+                }
+            }
+        }
+    }
+    
+    #undef ADJ
+    #undef SET_ADJ
+    #undef CLEAR_ADJ
+    
+    if (ok) {
+        // Upward arcs grouped by source, sorted by target for findArc
+        state->chUpStart[0] = 0;
+        for (int c = 0; c < n; c++) {
+            state->chUpStart[c + 1] = state->chUpStart[c] + upCount[c];
+            upCount[c] = state->chUpStart[c];
+        }
+        for (int a = 0; a < nbArcs; a++) {
+            state->chUpTarget[upCount[arcSource[a]]++] = arcTarget[a];
+        }
+        for (int c = 0; c < n; c++) {
+            qsort(&state->chUpTarget[state->chUpStart[c]], state->chUpStart[c + 1] - state->chUpStart[c],
+                  sizeof(int), compareInts);
+        }
+        state->chNbArcs = nbArcs;
+        
+        // Downward view: the lower cities holding an arc to each city
+        memset(upCount, 0, sizeof(int) * (n + 1));
+        for (int a = 0; a < nbArcs; a++) {
+            upCount[arcTarget[a]]++;
+        }
+        state->chDownStart[0] = 0;
+        for (int c = 0; c < n; c++) {
+            state->chDownStart[c + 1] = state->chDownStart[c] + upCount[c];
+            upCount[c] = state->chDownStart[c];
+        }
+        for (int a = 0; a < nbArcs; a++) {
+            state->chDownSource[upCount[arcTarget[a]]++] = arcSource[a];
+        }
+    }
+    
+    free(adjacency);
+    free(degree);
+    free(eliminated);
+    free(upCount);
+    free(arcSource);
+    free(arcTarget);
+    free(neighbours);
+    return ok;
+}
+
+// Elimination tree parent: lowest ranked upward neighbour; every upward
+// neighbour of a city is one of its ancestors
+static void buildEliminationTree(GameState* state) {
+    for (int c = 0; c < state->nbCities; c++) {
+        state->chParent[c] = -1;
+        for (int a = state->chUpStart[c]; a < state->chUpStart[c + 1]; a++) {
+            int u = state->chUpTarget[a];
+            if (state->chParent[c] < 0 || state->chRank[u] < state->chRank[state->chParent[c]]) {
+                state->chParent[c] = u;
+            }
+        }
+    }
+}
+
+void initHierarchy(GameState* state) {
+    if (!state) {
+        return;
+    }
+    
+    state->chReady = 0;
+    state->chVersion = -1;
+    
+    if (state->nbCities <= 0 || state->nbCities > MAX_CITIES || !contractGraph(state)) {
+        return;
+    }
+    
+    buildEliminationTree(state);
+    
+    for (int r = 0; r < state->nbTracks; r++) {
+        int a = state->routes[r].from;
+        int b = state->routes[r].to;
+        state->chRouteArc[r] = (a == b) ? -1 : findArc(state, a, b);
+    }
+    
+    state->chReady = 1;
+}
+
+// Base weights from the routes, then lower triangles processed bottom-up
+static void customize(GameState* state) {
+    int n = state->nbCities;
+    
+    for (int a = 0; a < state->chNbArcs; a++) {
+        state->chBaseWeight[a] = CH_INF;
+    }
+    for (int r = 0; r < state->nbTracks; r++) {
+        int a = state->chRouteArc[r];
+        int w = arcWeightOfRoute(state, r);
+        if (a >= 0 && w < state->chBaseWeight[a]) {
+            state->chBaseWeight[a] = w;
+        }
+    }
+    memcpy(state->chWeight, state->chBaseWeight, sizeof(int) * state->chNbArcs);
+    
+    int* byRank = malloc(sizeof(int) * n);
+    if (!byRank) {
+        state->chReady = 0;
+        return;
+    }
+    for (int c = 0; c < n; c++) {
+        byRank[state->chRank[c]] = c;
+    }
+    
+    for (int k = 0; k < n; k++) {
+        int v = byRank[k];
+        for (int i = state->chUpStart[v]; i < state->chUpStart[v + 1]; i++) {
+            if (state->chWeight[i] >= CH_INF) continue;
+            
+            for (int j = i + 1; j < state->chUpStart[v + 1]; j++) {
+                if (state->chWeight[j] >= CH_INF) continue;
+                
+                int upper = findArc(state, state->chUpTarget[i], state->chUpTarget[j]);
+                int through = state->chWeight[i] + state->chWeight[j];
+                if (upper >= 0 && through < state->chWeight[upper]) {
+                    state->chWeight[upper] = through;
+                }
+            }
+        }
+    }
+    
+    free(byRank);
+    state->chVersion = state->ownershipVersion;
+}
+
+int hierarchyReady(GameState* state) {
+    if (!state || !state->chReady) {
+        return 0;
+    }
+    
+    if (state->chVersion != state->ownershipVersion) {
+        customize(state);
+    }
+    return state->chReady;
+}
+
+// Upward search restricted to the ancestors of source in the elimination tree
+static int climb(GameState* state, int source, int* chain, int* dist, int* pred) {
+    int length = 0;
+    for (int c = source; c >= 0; c = state->chParent[c]) {
+        chain[length++] = c;
+        dist[c] = CH_INF;
+        pred[c] = -1;
+    }
+    dist[source] = 0;
+    
+    for (int i = 0; i < length; i++) {
+        int x = chain[i];
+        if (dist[x] >= CH_INF) continue;
+        
+        for (int a = state->chUpStart[x]; a < state->chUpStart[x + 1]; a++) {
+            int y = state->chUpTarget[a];
+            if (state->chWeight[a] < CH_INF && dist[x] + state->chWeight[a] < dist[y]) {
+                dist[y] = dist[x] + state->chWeight[a];
+                pred[y] = x;
+            }
+        }
+    }
+    
+    return length;
+}
+
+typedef struct {
+    int chainFrom[MAX_CITIES];
+    int chainTo[MAX_CITIES];
+    int distFrom[MAX_CITIES];
+    int distTo[MAX_CITIES];
+    int predFrom[MAX_CITIES];
+    int predTo[MAX_CITIES];
+    unsigned char onFromChain[MAX_CITIES];
+} HierarchyQuery;
+
+static int runQuery(GameState* state, HierarchyQuery* q, int from, int to, int* meeting) {
+    int lengthFrom = climb(state, from, q->chainFrom, q->distFrom, q->predFrom);
+    int lengthTo = climb(state, to, q->chainTo, q->distTo, q->predTo);
+    
+    for (int i = 0; i < lengthFrom; i++) {
+        q->onFromChain[q->chainFrom[i]] = 1;
+    }
+    
+    int best = CH_INF;
+    *meeting = -1;
+    for (int i = 0; i < lengthTo; i++) {
+        int c = q->chainTo[i];
+        if (q->onFromChain[c] && q->distFrom[c] + q->distTo[c] < best) {
+            best = q->distFrom[c] + q->distTo[c];
+            *meeting = c;
+        }
+    }
+    
+    for (int i = 0; i < lengthFrom; i++) {
+        q->onFromChain[q->chainFrom[i]] = 0;
+    }
+    
+    return best;
+}
+
+int hierarchyDistance(GameState* state, int from, int to) {
+    if (!hierarchyReady(state) || from < 0 || from >= state->nbCities || to < 0 || to >= state->nbCities) {
+        return -1;
+    }
+    
+    HierarchyQuery q;
+    memset(q.onFromChain, 0, sizeof(unsigned char) * state->nbCities);
+    
+    int meeting;
+    int best = runQuery(state, &q, from, to, &meeting);
+    
+    return best >= CH_INF ? -1 : best;
+}
+
+// Appends the cities strictly after a up to b, expanding shortcuts
+// through the lower triangle that realises their weight
+static int unpackArc(GameState* state, int a, int b, int* path, int* pathLength) {
+    int arc = findArc(state, a, b);
+    if (arc < 0 || *pathLength >= MAX_CITIES) {
+        return 0;
+    }
+    
+    int weight = state->chWeight[arc];
+    if (state->chBaseWeight[arc] == weight) {
+        path[(*pathLength)++] = b;
+        return 1;
+    }
+    
+    int low = (state->chRank[a] < state->chRank[b]) ? a : b;
+    int high = (low == a) ? b : a;
+    
+    for (int k = state->chDownStart[low]; k < state->chDownStart[low + 1]; k++) {
+        int v = state->chDownSource[k];
+        int toLow = findArc(state, v, low);
+        int toHigh = findArc(state, v, high);
+        if (toLow < 0 || toHigh < 0 || state->chWeight[toLow] >= CH_INF || state->chWeight[toHigh] >= CH_INF) continue;
+        
+        if (state->chWeight[toLow] + state->chWeight[toHigh] == weight) {
+            return unpackArc(state, a, v, path, pathLength) && unpackArc(state, v, b, path, pathLength);
+        }
+    }
+    
+    return 0;
+}
+
+int hierarchyPath(GameState* state, int from, int to, int* path, int* pathLength) {
+    if (!path || !pathLength || !hierarchyReady(state) || from < 0 || from >= state->nbCities ||
+        to < 0 || to >= state->nbCities) {
+        return -1;
+    }
+    
+    HierarchyQuery query;
+    HierarchyQuery* q = &query;
+    memset(q->onFromChain, 0, sizeof(unsigned char) * state->nbCities);
+    
+    int meeting;
+    int best = runQuery(state, q, from, to, &meeting);
+    if (best >= CH_INF) {
+        return -1;
+    }
+    
+    // Up from the source to the meeting city, then down to the target
+    int up[MAX_CITIES];
+    int nbUp = 0;
+    for (int c = meeting; c != from; c = q->predFrom[c]) {
+        up[nbUp++] = c;
+    }
+    
+    int ok = 1;
+    *pathLength = 0;
+    path[(*pathLength)++] = from;
+    
+    int current = from;
+    for (int i = nbUp - 1; ok && i >= 0; i--) {
+        ok = unpackArc(state, current, up[i], path, pathLength);
+        current = up[i];
+    }
+    for (int c = meeting; ok && c != to; c = q->predTo[c]) {
+        ok = unpackArc(state, c, q->predTo[c], path, pathLength);
+    }
+    
+    return ok ? best : -1;
+}
\ No newline at end of file
@@ -0,0 +1,11 @@
+#ifndef HIERARCHY_H
+#define HIERARCHY_H
+#include "gamestate.h"
+#include "../tickettorideapi/ticketToRide.h"
+
+void initHierarchy(GameState* state);
+int hierarchyReady(GameState* state);
+int hierarchyDistance(GameState* state, int from, int to);
+int hierarchyPath(GameState* state, int from, int to, int* path, int* pathLength);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include "../tickettorideapi/ticketToRide.h"
+#include "../tickettorideapi/clientAPI.h"
+#include "protocol.h"
+
+// Client API over the line protocol of protocol.h, linked instead of the API sources in
+// tickettoridebot-local: the sequential mode, -p, record and replay then play against
+// t2rserver. One blocking connection per process, like the API it stands in for.
+
+static int serverFd = -1;
+static ProtoBuffer serverIn;
+static ProtoBuffer serverOut;
+static int lastFrameLength;   // answer still in serverIn, consumed by the next request
+
+static void closeServer(void) {
+    if (serverFd >= 0) close(serverFd);
+    serverFd = -1;
+    freeProtoBuffer(&serverIn);
+    freeProtoBuffer(&serverOut);
+    lastFrameLength = 0;
+}
+
+static int openServer(const char* host, unsigned int port) {
+    char service[16];
+    snprintf(service, sizeof(service), "%u", port);
+    
+    struct addrinfo hints;
+    struct addrinfo* addresses;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, service, &hints, &addresses) != 0) {
+        return -1;
+    }
+    
+    int fd = -1;
+    for (struct addrinfo* a = addresses; a && fd < 0; a = a->ai_next) {
+        fd = socket(a->ai_family, a->ai_socktype | SOCK_CLOEXEC, a->ai_protocol);
+        if (fd < 0) continue;
+        
+        if (connect(fd, a->ai_addr, a->ai_addrlen) < 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+    
+    // One small request at a time: never wait for Nagle
+    if (fd >= 0) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    return fd;
+}
+
+// Sends one request and waits for its answer, which must be the expected command.
+// The frame points into serverIn until the next request
+static ResultCode exchange(const char* command, const int* values, int count, const char* payload,
+                           int payloadLength, const char* expected, ProtoFrame* frame) {
+    if (serverFd < 0) {
+        return PARAM_ERROR;
+    }
+    
+    protoConsume(&serverIn, lastFrameLength);
+    lastFrameLength = 0;
+    if (!writeFrame(&serverOut, command, values, count, payload, payloadLength)) {
+        return MEMORY_ALLOCATION_ERROR;
+    }
+    
+    while (serverOut.length > 0) {
+        ssize_t sent = send(serverFd, serverOut.data, serverOut.length, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            return SERVER_ERROR;
+        }
+        protoConsume(&serverOut, sent);
+    }
+    
+    int status;
+    while ((status = readFrame(&serverIn, frame)) == 0) {
+        char chunk[4096];
+        ssize_t received = recv(serverFd, chunk, sizeof(chunk), 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0 || !protoAppend(&serverIn, chunk, received)) {
+            return SERVER_ERROR;
+        }
+    }
+    
+    if (status < 0 || strcmp(frame->command, expected) != 0) {
+        fprintf(stderr, "Local API: %s answered by %s\n", command, status < 0 ? "a bad frame" : frame->command);
+        return SERVER_ERROR;
+    }
+    lastFrameLength = frame->frameLength;
+    return ALL_GOOD;
+}
+
+// Server message as the API hands it over, allocated, NULL when empty
+static char* copyMessage(const ProtoFrame* frame) {
+    if (frame->payloadLength <= 0) {
+        return NULL;
+    }
+    
+    char* message = malloc(frame->payloadLength + 1);
+    if (message) {
+        memcpy(message, frame->payload, frame->payloadLength);
+        message[frame->payloadLength] = '\0';
+    }
+    return message;
+}
+
+ResultCode connectToCGS(const char* serverName, unsigned int port, const char* name) {
+    closeServer();
+    serverFd = openServer(serverName, port);
+    if (serverFd < 0) {
+        return SERVER_ERROR;
+    }
+    
+    ProtoFrame frame;
+    ResultCode code = exchange("CONNECT", NULL, 0, name, strlen(name), "OK", &frame);
+    if (code != ALL_GOOD) {
+        closeServer();
+    }
+    return code;
+}
+
+ResultCode sendGameSettings(const char* gameSettings, GameData* gameData) {
+    memset(gameData, 0, sizeof(GameData));
+    
+    ProtoFrame frame;
+    ResultCode code = exchange("WAIT_GAME", NULL, 0, gameSettings, strlen(gameSettings), "GAME", &frame);
+    if (code != ALL_GOOD) {
+        return code;
+    }
+    return parseGameFrame(&frame, gameData) ? ALL_GOOD : SERVER_ERROR;
+}
+
+// The face-up row some answers carry is dropped: the API has no room for it
+ResultCode getMove(MoveData* moveData, MoveResult* moveResult) {
+    memset(moveData, 0, sizeof(MoveData));
+    memset(moveResult, 0, sizeof(MoveResult));
+    
+    ProtoFrame frame;
+    ResultCode code = exchange("GET_MOVE", NULL, 0, NULL, 0, "MOVE", &frame);
+    if (code != ALL_GOOD) {
+        return code;
+    }
+    
+    int values[13];
+    int count = parseInts(frame.args, values, 13);
+    if (count != 8 && count != 13) {
+        return SERVER_ERROR;
+    }
+    
+    moveResult->state = values[1];
+    moveResult->replay = values[2] != 0;
+    moveFromArgs(values[3], values + 4, moveData);
+    moveResult->message = copyMessage(&frame);
+    return values[0];
+}
+
+ResultCode sendMove(const MoveData* moveData, MoveResult* moveResult) {
+    memset(moveResult, 0, sizeof(MoveResult));
+    
+    int values[18];
+    values[0] = moveData->action;
+    moveToArgs(moveData, values + 1);
+    
+    ProtoFrame frame;
+    ResultCode code = exchange("PLAY_MOVE", values, 5, NULL, 0, "RESULT", &frame);
+    if (code != ALL_GOOD) {
+        return code;
+    }
+    
+    int count = parseInts(frame.args, values, 18);
+    if (count != 13 && count != 18) {
+        return SERVER_ERROR;
+    }
+    
+    resultFromArgs(values + 1, moveResult);
+    moveResult->message = copyMessage(&frame);
+    return values[0];
+}
+
+ResultCode getBoardState(BoardState* boardState) {
+    ProtoFrame frame;
+    ResultCode code = exchange("GET_BOARD", NULL, 0, NULL, 0, "BOARD", &frame);
+    if (code != ALL_GOOD) {
+        return code;
+    }
+    
+    int values[6];
+    if (parseInts(frame.args, values, 6) != 6) {
+        return SERVER_ERROR;
+    }
+    
+    for (int i = 0; i < 5; i++) {
+        boardState->card[i] = values[i + 1];
+    }
+    return values[0];
+}
+
+ResultCode quitGame(void) {
+    ProtoFrame frame;
+    ResultCode code = exchange("QUIT", NULL, 0, NULL, 0, "BYE", &frame);
+    closeServer();
+    return code;
+}
+
+// Nothing to draw: t2rserver keeps the board on its side
+void printBoard(void) {
+}
\ No newline at end of file
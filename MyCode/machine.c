@@ -0,0 +1,287 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "machine.h"
+#include "gamestate.h"
+#include "strategy.h"
+#include "msgclass.h"
+
+#define MACHINE_MAX_TURNS 200
+#define MACHINE_MAX_ERRORS 10
+
+static const char* phaseNames[TURN_PHASES] = {
+    [TURN_WAIT_OPPONENT] = "wait opponent",
+    [TURN_FIRST_ACTION] = "first action",
+    [TURN_SECOND_DRAW] = "second draw",
+    [TURN_CHOOSE_OBJECTIVES] = "choose objectives",
+    [TURN_GAME_OVER] = "game over",
+};
+
+static double nowMs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+}
+
+// Time is charged to the phase being left, server waits and decisions alike
+static void setPhase(TurnMachine* machine, TurnPhase phase) {
+    double now = nowMs();
+    machine->phaseMs[machine->phase] += now - machine->phaseStartedAt;
+    machine->phaseSteps[machine->phase]++;
+    machine->phaseStartedAt = now;
+    machine->phase = phase;
+    machine->decided = 0;
+}
+
+// The server ends a game with a score summary, sometimes behind an error code
+static int endsGame(const TurnAnswer* answer) {
+    if (answer->code == ALL_GOOD && (answer->result.state == WINNING_MOVE || answer->result.state == LOOSING_MOVE)) {
+        return 1;
+    }
+    
+    MessageKind kind = classifyPayload(answer->message, answer->messageLength);
+    return kind == MESSAGE_GAME_OVER || kind == MESSAGE_NO_GAME || kind == MESSAGE_API_ERROR;
+}
+
+// Ended by the server: the driver keeps the message of the answer that got us here.
+// Given up on our side otherwise, the server may still be running the game
+static void endGame(TurnMachine* machine, int byServer) {
+    machine->aborted = !byServer;
+    setPhase(machine, TURN_GAME_OVER);
+}
+
+// A failed request is never sent again: the game is given up
+static void abortGame(TurnMachine* machine, const char* call, const TurnAnswer* answer) {
+    int length = answer->message ? answer->messageLength : 0;
+    printf("Game %d: %s failed (0x%x)%s%.*s, game abandoned\n", machine->gameNumber, call, answer->code,
+           length > 0 ? ": " : "", length, length > 0 ? answer->message : "");
+    endGame(machine, 0);
+}
+
+// Refused moves, answered by a blind draw, up to a limit for the whole game
+static void countError(TurnMachine* machine) {
+    if (++machine->errors > MACHINE_MAX_ERRORS) {
+        endGame(machine, 0);
+    }
+}
+
+static void startOurTurn(TurnMachine* machine) {
+    GameState* state = &machine->game->state;
+    if (++machine->turns > MACHINE_MAX_TURNS) {
+        endGame(machine, 0);
+        return;
+    }
+    
+    if (state->wagonsLeft <= 0) {
+        state->lastTurn = 1;
+    }
+    
+    if (machine->turns % 10 == 0 || state->lastTurn) {
+        printf("Game %d Turn %d - Wagons: Us=%d, Opp=%d%s\n",
+               machine->gameNumber, machine->turns, state->wagonsLeft, state->opponentWagonsLeft,
+               state->lastTurn ? " [LAST TURN]" : "");
+    }
+    setPhase(machine, TURN_FIRST_ACTION);
+    
+    // The opening ticket draw needs no decision
+    if (machine->firstTurn) {
+        memset(&machine->move, 0, sizeof(MoveData));
+        machine->move.action = DRAW_OBJECTIVES;
+        machine->decided = 1;
+    }
+}
+
+static void onOpponentMove(TurnMachine* machine, const TurnAnswer* answer) {
+    GameState* state = &machine->game->state;
+    
+    if (endsGame(answer)) {
+        endGame(machine, 1);
+    } else if (answer->code == ALL_GOOD) {
+        updateAfterOpponentMove(state, (MoveData*)&answer->move);
+        if (answer->hasBoard) {
+            setVisibleCards(state, answer->board);
+        }
+        if (state->opponentWagonsLeft <= 2) {
+            state->lastTurn = 1;
+        }
+        
+        if (!answer->result.replay) {
+            startOurTurn(machine);
+        }
+    } else if (classifyPayload(answer->message, answer->messageLength) == MESSAGE_OUR_TURN) {
+        startOurTurn(machine);
+    } else {
+        abortGame(machine, "getMove", answer);
+    }
+}
+
+static void onBoard(TurnMachine* machine, const TurnAnswer* answer) {
+    if (answer->code != ALL_GOOD) {
+        abortGame(machine, "getBoardState", answer);
+        return;
+    }
+    setVisibleCards(&machine->game->state, answer->board);
+}
+
+// Tickets offered outside the map end the game before any choice is made
+static void onObjectivesOffered(TurnMachine* machine, const MoveResult* result) {
+    GameState* state = &machine->game->state;
+    memcpy(machine->offered, result->objectives, sizeof(machine->offered));
+    
+    for (int i = 0; i < 3; i++) {
+        if ((int)machine->offered[i].from >= state->nbCities || (int)machine->offered[i].to >= state->nbCities) {
+            printf("Game %d: invalid objectives offered\n", machine->gameNumber);
+            endGame(machine, 0);
+            return;
+        }
+    }
+    setPhase(machine, TURN_CHOOSE_OBJECTIVES);
+}
+
+static void onMoveSent(TurnMachine* machine, const TurnAnswer* answer) {
+    GameContext* game = machine->game;
+    GameState* state = &game->state;
+    
+    if (endsGame(answer)) {
+        endGame(machine, 1);
+        return;
+    }
+    
+    if (answer->code != ALL_GOOD) {
+        abortGame(machine, "sendMove", answer);
+        return;
+    }
+    
+    // Refused move: fall back on a blind draw, always legal
+    if (answer->result.state == ILLEGAL_MOVE) {
+        if (answer->message && answer->messageLength > 0) {
+            printf("Server message: %.*s\n", answer->messageLength, answer->message);
+        }
+        
+        state->visibleCardsKnown = 0;
+        if (machine->move.action == DRAW_BLIND_CARD) {
+            endGame(machine, 0);
+            return;
+        }
+        countError(machine);
+        if (machine->phase != TURN_GAME_OVER) {
+            memset(&machine->move, 0, sizeof(MoveData));
+            machine->move.action = DRAW_BLIND_CARD;
+            machine->decided = 1;
+        }
+        return;
+    }
+    
+    switch (machine->move.action) {
+        case DRAW_OBJECTIVES:
+            onObjectivesOffered(machine, &answer->result);
+            return;
+        
+        case CHOOSE_OBJECTIVES:
+            for (int i = 0; i < 3; i++) {
+                if (machine->keep[i]) {
+                    addObjectives(state, &machine->offered[i], 1);
+                }
+            }
+            machine->firstTurn = 0;
+            break;
+        
+        default:
+            break;
+    }
+    
+    applyMoveResult(game, &machine->move, &answer->result);
+    if (answer->hasBoard) {
+        setVisibleCards(state, answer->board);
+    }
+    
+    if (state->wagonsLeft <= 2 && state->lastTurn == 0) {
+        state->lastTurn = 1;
+    }
+    setPhase(machine, game->cardDrawnThisTurn == 1 ? TURN_SECOND_DRAW : TURN_WAIT_OPPONENT);
+}
+
+void startTurnMachine(TurnMachine* machine, int gameNumber, GameContext* game, int starter) {
+    memset(machine, 0, sizeof(TurnMachine));
+    machine->game = game;
+    machine->gameNumber = gameNumber;
+    machine->firstTurn = 1;
+    machine->phase = TURN_WAIT_OPPONENT;
+    machine->phaseStartedAt = nowMs();
+    
+    // Nothing was waited for before our first move
+    if (starter == 0) {
+        startOurTurn(machine);
+        machine->phaseSteps[TURN_WAIT_OPPONENT] = 0;
+    }
+}
+
+// Our move needs the face-up row, then a decision, then goes out
+TurnNeed nextTurnNeed(const TurnMachine* machine) {
+    switch (machine->phase) {
+        case TURN_WAIT_OPPONENT:
+            return TURN_NEED_MOVE;
+        case TURN_FIRST_ACTION:
+        case TURN_SECOND_DRAW:
+            if (machine->decided) {
+                return TURN_NEED_SEND;
+            }
+            return machine->game->state.visibleCardsKnown ? TURN_NEED_DECISION : TURN_NEED_BOARD;
+        case TURN_CHOOSE_OBJECTIVES:
+            return machine->decided ? TURN_NEED_SEND : TURN_NEED_DECISION;
+        default:
+            return TURN_NEED_NOTHING;
+    }
+}
+
+// prepareMove knows a first action from a second draw by cardDrawnThisTurn
+void decideTurn(TurnMachine* machine) {
+    if (machine->phase == TURN_CHOOSE_OBJECTIVES) {
+        memset(machine->keep, 1, sizeof(machine->keep));
+        chooseObjectivesStrategy(&machine->game->state, machine->offered, machine->keep);
+        if (!machine->keep[0] && !machine->keep[1] && !machine->keep[2]) {
+            machine->keep[0] = 1;
+        }
+        
+        memset(&machine->move, 0, sizeof(MoveData));
+        machine->move.action = CHOOSE_OBJECTIVES;
+        for (int i = 0; i < 3; i++) {
+            machine->move.chooseObjectives[i] = machine->keep[i];
+        }
+    } else {
+        memset(&machine->move, 0, sizeof(MoveData));
+        prepareMove(machine->game, &machine->move);
+    }
+    machine->decided = 1;
+}
+
+// The answer is to the request nextTurnNeed named
+void answerTurn(TurnMachine* machine, const TurnAnswer* answer) {
+    switch (nextTurnNeed(machine)) {
+        case TURN_NEED_MOVE:
+            onOpponentMove(machine, answer);
+            break;
+        case TURN_NEED_BOARD:
+            onBoard(machine, answer);
+            break;
+        case TURN_NEED_SEND:
+            onMoveSent(machine, answer);
+            break;
+        default:
+            break;
+    }
+}
+
+void printPhaseTimes(const TurnMachine* machine) {
+    const char* separator = "";
+    printf("Time per phase: ");
+    for (int i = 0; i < TURN_GAME_OVER; i++) {
+        if (machine->phaseSteps[i] > 0) {
+            printf("%s%s %.1f ms x%d", separator, phaseNames[i],
+                   machine->phaseMs[i] / machine->phaseSteps[i], machine->phaseSteps[i]);
+            separator = ", ";
+        }
+    }
+    printf("\n");
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#ifndef MACHINE_H
+#define MACHINE_H
+#include "player.h"
+#include "../tickettorideapi/ticketToRide.h"
+
+// Phases of one game, shared by the sequential mode (blocking client API) and the
+// session loop (line protocol). The machine does no I/O: it names the next request,
+// the driver sends it and hands the answer back, so each step is exactly one request
+typedef enum {
+    TURN_WAIT_OPPONENT,      // asking for the opponent's move
+    TURN_FIRST_ACTION,       // our move, the opening ticket draw on our first turn
+    TURN_SECOND_DRAW,        // second card of a two-card draw
+    TURN_CHOOSE_OBJECTIVES,  // keeping some of the tickets just drawn
+    TURN_GAME_OVER,
+    TURN_PHASES
+} TurnPhase;
+
+// What the machine waits for
+typedef enum {
+    TURN_NEED_NOTHING,       // game over
+    TURN_NEED_MOVE,          // getMove, the opponent's move
+    TURN_NEED_BOARD,         // getBoardState, the face-up row is unknown
+    TURN_NEED_DECISION,      // decideTurn, no I/O, may run on another thread
+    TURN_NEED_SEND           // sendMove of machine->move
+} TurnNeed;
+
+// Answer to the last request, whichever way it came
+typedef struct {
+    ResultCode code;
+    MoveData move;           // the opponent's move, for getMove
+    MoveResult result;       // its messages are not read, see message
+    const char* message;     // server message, not NUL-terminated, NULL if none
+    int messageLength;
+    CardColor board[5];      // face-up row: getBoardState, or after a move when hasBoard
+    int hasBoard;
+} TurnAnswer;
+
+typedef struct {
+    TurnPhase phase;
+    GameContext* game;
+    int gameNumber;
+    int firstTurn;
+    int turns;
+    int errors;                     // refused moves
+    int aborted;                    // given up on our side, not ended by the server
+    int decided;                    // move holds what to send in this phase
+    
+    MoveData move;                  // move decided or sent
+    Objective offered[3];
+    unsigned char keep[3];
+    
+    double phaseStartedAt;
+    double phaseMs[TURN_PHASES];    // time spent in each phase, server and decisions
+    int phaseSteps[TURN_PHASES];
+} TurnMachine;
+
+void startTurnMachine(TurnMachine* machine, int gameNumber, GameContext* game, int starter);
+TurnNeed nextTurnNeed(const TurnMachine* machine);
+void decideTurn(TurnMachine* machine);
+void answerTurn(TurnMachine* machine, const TurnAnswer* answer);
+void printPhaseTimes(const TurnMachine* machine);
+
+#endif
\ No newline at end of file
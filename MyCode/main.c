@@ -3,27 +3,29 @@
 #include <string.h>
 #include <stdbool.h>
 #include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/wait.h>
 #include "../tickettorideapi/ticketToRide.h"
 #include "../tickettorideapi/clientAPI.h"
 #include "gamestate.h"
 #include "player.h"
 #include "strategy.h"
 #include "rules.h"
+#include "book.h"
+#include "session.h"
+#include "record.h"
+#include "machine.h"
+#include "mapdump.h"
 
-#define MAX_TURNS 200
 #define NUMBER_OF_GAMES 3
+#define MAX_SESSION_GAMES 1000
+#define SERVER_ADDRESS "82.29.170.160"
+#define SERVER_PORT 15001
+#define PLAYER_NAME "GeorgesSKAF"
+#define GAME_SETTINGS "TRAINING NICE_BOT"
 
-typedef struct {
-    int gameNumber;
-    int finalScore;
-    int wagonsLeft;
-    int objectivesCompleted;
-    int totalObjectives;
-    char serverResults[2048];
-    bool hasServerResults;
-} GameResult;
-
-void printGameResult(int gameNumber, int finalScore, char* finalResultsMessage, bool hasServerResults) {
+void printGameResult(int gameNumber, int finalScore, const char* finalResultsMessage, bool hasServerResults) {
     printf("\n=== GAME %d RESULTS ===\n", gameNumber);
     
     if (finalResultsMessage && strlen(finalResultsMessage) > 0) {
@@ -36,373 +38,402 @@ void printGameResult(int gameNumber, int finalScore, char* finalResultsMessage,
     printf("======================\n\n");
 }
 
-bool updateBoardState(GameState* gameState) {
-    BoardState boardState;
-    ResultCode result = getBoardState(&boardState);
+// Highest scoring other player of a server summary, NULL without one
+static const PlayerResult* bestOpponent(const GameResult* gameResult, const char* playerName) {
+    const PlayerResult* ours = findPlayerResult(&gameResult->serverResults, playerName);
+    const PlayerResult* best = NULL;
     
-    if (result != ALL_GOOD) return false;
+    for (int i = 0; i < gameResult->serverResults.nbPlayers; i++) {
+        const PlayerResult* player = &gameResult->serverResults.players[i];
+        if (player != ours && (!best || player->score > best->score)) {
+            best = player;
+        }
+    }
+    return best;
+}
+
+// The connection is kept between games; the server takes the next WAIT_GAME once a game is over
+static ResultCode startGame(int gameNumber, const SessionConfig* config, bool* connected, GameData* gameData) {
+    ResultCode result;
     
-    for (int i = 0; i < 5; i++) {
-        gameState->visibleCards[i] = boardState.card[i];
+    if (*connected) {
+        result = tracedGameSettings(config->settings, gameData);
+        if (result == ALL_GOOD) {
+            return ALL_GOOD;
+        }
+        
+        // Dropped between games: one fresh connection
+        printf("Kept connection refused game %d: 0x%x, reconnecting\n", gameNumber, result);
+        tracedQuit();
+        *connected = false;
     }
     
-    return true;
+    result = tracedConnect(config->host, config->port, config->playerName);
+    if (result != ALL_GOOD) {
+        printf("Connection failed for game %d: 0x%x\n", gameNumber, result);
+        return result;
+    }
+    *connected = true;
+    
+    result = tracedGameSettings(config->settings, gameData);
+    if (result != ALL_GOOD) {
+        printf("Settings failed for game %d: 0x%x\n", gameNumber, result);
+    }
+    return result;
 }
 
-bool isGameOver(char* message) {
-    if (!message) return false;
-    
-    return (strstr(message, "Total score:") != NULL && strstr(message, "pts") != NULL) ||
-           (strstr(message, "Georges:") != NULL && strstr(message, "PlayNice:") != NULL && strstr(message, "Objective") != NULL) ||
-           (strstr(message, "Player Georges has the longest path") != NULL) ||
-           (strstr(message, "Player PlayNice has the longest path") != NULL) ||
-           (strstr(message, "✔Objective") != NULL && strstr(message, "✘Objective") != NULL) ||
-           (strstr(message, "[getCGSMove]") != NULL);
+// Each request the machine names goes through the traced client API. Returns the
+// message of the answer that ended the game, taken over from its result, or NULL
+static char* playTurns(TurnMachine* machine) {
+    char* finalMessage = NULL;
+    TurnNeed need;
+    
+    while ((need = nextTurnNeed(machine)) != TURN_NEED_NOTHING) {
+        if (need == TURN_NEED_DECISION) {
+            decideTurn(machine);
+            continue;
+        }
+        
+        TurnAnswer answer;
+        memset(&answer, 0, sizeof(TurnAnswer));
+        if (need == TURN_NEED_MOVE) {
+            answer.code = tracedGetMove(&answer.move, &answer.result);
+        } else if (need == TURN_NEED_BOARD) {
+            BoardState boardState;
+            answer.code = tracedGetBoardState(&boardState);
+            memcpy(answer.board, boardState.card, sizeof(answer.board));
+            answer.hasBoard = answer.code == ALL_GOOD;
+        } else {
+            answer.code = tracedSendMove(&machine->move, &answer.result);
+        }
+        answer.message = answer.result.message;
+        answer.messageLength = answer.message ? (int)strlen(answer.message) : 0;
+        
+        answerTurn(machine, &answer);
+        if (machine->phase == TURN_CHOOSE_OBJECTIVES && !machine->decided) {
+            dumpTickets(machine->offered, 3);
+        }
+        if (machine->phase == TURN_GAME_OVER && !machine->aborted) {
+            finalMessage = answer.result.message;
+            answer.result.message = NULL;
+        }
+        cleanupMoveResult(&answer.result);
+    }
+    return finalMessage;
 }
 
-int playOneGame(int gameNumber, GameResult* gameResult) {
+int playOneGame(int gameNumber, const SessionConfig* config, bool* connected, GameResult* gameResult) {
     printf("\n========================================\n");
     printf("           STARTING GAME %d\n", gameNumber);
     printf("========================================\n");
     
-    const char* serverAddress = "82.29.170.160";
-    unsigned int serverPort = 15001;
-    const char* playerName = "GeorgesSKAF";
-    
-    ResultCode result = connectToCGS(serverAddress, serverPort, playerName);
-    if (result != ALL_GOOD) {
-        printf("Connection failed for game %d: 0x%x\n", gameNumber, result);
-        return -1;
-    }
-    
     GameData gameData;
-
-    result = sendGameSettings("TRAINING NICE_BOT", &gameData);
-    if (result != ALL_GOOD) {
-        printf("Settings failed for game %d: 0x%x\n", gameNumber, result);
+    if (startGame(gameNumber, config, connected, &gameData) != ALL_GOOD) {
         return -1;
     }
-
+    
     printf("Game %d started: %s, Seed: %d, Starter: %d\n", 
            gameNumber, gameData.gameName, gameData.gameSeed, gameData.starter);
     
-    GameState gameState;
-    initPlayer(&gameState, &gameData);
+    // Heap: the context grows with MAX_CITIES/MAX_ROUTES, one per game
+    GameContext* game = malloc(sizeof(GameContext));
+    if (!game) {
+        printf("Out of memory for game %d\n", gameNumber);
+        return -1;
+    }
+    GameState* gameState = &game->state;
+    initPlayer(game, &gameData);
+    dumpGameMap(gameState);
+    
+    TurnMachine machine;
+    startTurnMachine(&machine, gameNumber, game, gameData.starter);
+    char* serverMessage = playTurns(&machine);
+    printPhaseTimes(&machine);
+    
+    int finalScore = calculateScore(gameState);
+    
+    int completedObjectives = 0;
+    for (int i = 0; i < gameState->nbObjectives; i++) {
+        if (isObjectiveCompleted(gameState, gameState->objectives[i])) {
+            completedObjectives++;
+        }
+    }
+    
+    fillGameResult(gameResult, gameNumber, gameState, serverMessage, config->playerName);
+    
+    char localResults[256];
+    const char* finalResultsMessage = serverMessage;
+    
+    if (!finalResultsMessage || !*finalResultsMessage) {
+        snprintf(localResults, sizeof(localResults),
+                "Game %d final score: %d\nWagons left: %d\nObjectives completed: %d/%d\n",
+                gameNumber, finalScore, gameState->wagonsLeft, 
+                completedObjectives, gameState->nbObjectives);
+        finalResultsMessage = localResults;
+    }
+    
+    printGameResult(gameNumber, gameResult->finalScore, finalResultsMessage, gameResult->hasServerResults);
+    
+    if (gameData.gameName) free(gameData.gameName);
+    if (gameData.trackData) free(gameData.trackData);
+    
+    free(serverMessage);
+    free(game);
+    
+    // The server may still be running an abandoned game: never reuse that connection
+    if (config->reconnect || (machine.aborted && *connected)) {
+        tracedQuit();
+        *connected = false;
+    }
+    
+    return 0;
+}
 
-    if (gameData.starter == 0) {
-        playFirstTurn(&gameState);
+// One process of -p: games first, first + step, ... in turn on its own connection,
+// each result written to the pipe as soon as the game is over
+static void playProcessGames(const SessionConfig* config, int first, int step, int fd) {
+    bool connected = false;
+    GameResult gameResult;
+    
+    for (int gameNum = first; gameNum <= config->nbGames; gameNum += step) {
+        if (playOneGame(gameNum, config, &connected, &gameResult) == 0 &&
+            write(fd, &gameResult, sizeof(GameResult)) != sizeof(GameResult)) {
+            break;
+        }
     }
     
-    int turnCounter = 0;
-    bool firstTurn = true;
-    int consecutiveErrors = 0;
-    char lastErrorMessage[2048] = {0};
-    bool gameRunning = true;
-    bool gameEnded = false;
+    if (connected) {
+        tracedQuit();
+    }
+    close(fd);
+}
+
+// -p N against any server: the client API keeps one connection per process, so the
+// games in flight are N processes playing through it; results come back over pipes
+static int runProcesses(const SessionConfig* config, GameResult* results) {
+    int nbProcesses = config->nbParallel < config->nbGames ? config->nbParallel : config->nbGames;
+    struct pollfd* pipes = malloc(sizeof(struct pollfd) * nbProcesses);
+    GameResult* pending = malloc(sizeof(GameResult) * nbProcesses);
+    int* received = calloc(nbProcesses, sizeof(int));
+    if (!pipes || !pending || !received) {
+        free(pipes);
+        free(pending);
+        free(received);
+        return 0;
+    }
     
-    while (gameRunning && turnCounter < MAX_TURNS && !gameEnded) {
-        turnCounter++;
-        
-        MoveData dummyMove;
-        MoveResult currentResult = {0};
-        ResultCode currentCode = getMove(&dummyMove, &currentResult);
-        
-        if (currentResult.state != 0) {
-            if (currentResult.message) {
-                strncpy(lastErrorMessage, currentResult.message, sizeof(lastErrorMessage)-1);
-            }
-            cleanupMoveResult(&currentResult);
-            gameRunning = false;
-            gameEnded = true;
+    // Nothing buffered may be printed twice once forked
+    fflush(stdout);
+    int nbOpen = 0;
+    for (int i = 0; i < nbProcesses; i++) {
+        int ends[2];
+        if (pipe(ends) < 0) {
+            perror("pipe");
             break;
         }
         
-        if (currentResult.message && isGameOver(currentResult.message)) {
-            strncpy(lastErrorMessage, currentResult.message, sizeof(lastErrorMessage)-1);
-            cleanupMoveResult(&currentResult);
-            gameRunning = false;
-            gameEnded = true;
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            close(ends[0]);
+            close(ends[1]);
             break;
         }
+        if (pid == 0) {
+            for (int k = 0; k < nbOpen; k++) {
+                close(pipes[k].fd);
+            }
+            free(pipes);
+            free(pending);
+            free(received);
+            close(ends[0]);
+            setvbuf(stdout, NULL, _IOLBF, 0);
+            playProcessGames(config, i + 1, nbProcesses, ends[1]);
+            exit(0);
+        }
         
-        if (currentResult.message && 
-            ((strstr(currentResult.message, "Georges:") != NULL && 
-              strstr(currentResult.message, "PlayNice:") != NULL) ||
-             strstr(currentResult.message, "Total score:") != NULL)) {
-            
-            strncpy(lastErrorMessage, currentResult.message, sizeof(lastErrorMessage)-1);
-            cleanupMoveResult(&currentResult);
-            
-            gameRunning = false;
-            gameEnded = true;
+        close(ends[1]);
+        pipes[nbOpen].fd = ends[0];
+        pipes[nbOpen].events = POLLIN;
+        nbOpen++;
+    }
+    
+    // A result is read in as many pieces as the pipe hands it over
+    int completed = 0;
+    int nbLeft = nbOpen;
+    while (nbLeft > 0) {
+        if (poll(pipes, nbOpen, -1) < 0) {
+            if (errno == EINTR) continue;
             break;
         }
         
-        bool itsOurTurn = false;
-        
-        if (currentCode == ALL_GOOD) {
-            updateAfterOpponentMove(&gameState, &dummyMove);
-            
-            if (currentResult.message && 
-                (strstr(currentResult.message, "[getCGSMove]") != NULL ||
-                 strstr(currentResult.message, "Total score:") != NULL ||
-                 strstr(currentResult.message, "✔Objective") != NULL ||
-                 strstr(currentResult.message, "longest path") != NULL)) {
-                
-                strncpy(lastErrorMessage, currentResult.message, sizeof(lastErrorMessage)-1);
-                cleanupMoveResult(&currentResult);
-                
-                gameRunning = false;
-                gameEnded = true;
-                break;
+        for (int i = 0; i < nbOpen; i++) {
+            if (pipes[i].fd < 0 || !pipes[i].revents) {
+                continue;
             }
             
-            if (gameState.opponentWagonsLeft <= 0) {
-                gameState.lastTurn = 1;
-            } else if (gameState.opponentWagonsLeft <= 2) {
-                gameState.lastTurn = 1;
+            char* slot = (char*)&pending[i];
+            ssize_t length = read(pipes[i].fd, slot + received[i], sizeof(GameResult) - received[i]);
+            if (length <= 0) {
+                close(pipes[i].fd);
+                pipes[i].fd = -1;
+                nbLeft--;
+                continue;
             }
             
-            if (!currentResult.replay && !gameEnded) {
-                itsOurTurn = true;
-            }
-        }
-        else if (currentCode == SERVER_ERROR) {
-            if (currentResult.message) {
-                if (strstr(currentResult.message, "Bad protocol, should send 'WAIT_GAME") != NULL) {
-                    strncpy(lastErrorMessage, currentResult.message, sizeof(lastErrorMessage)-1);
-                    gameEnded = true;
-                    cleanupMoveResult(&currentResult);
-                    break;
-                }
-                
-                if (isGameOver(currentResult.message)) {
-                    strncpy(lastErrorMessage, currentResult.message, sizeof(lastErrorMessage)-1);
-                    cleanupMoveResult(&currentResult);
-                    
-                    gameRunning = false;
-                    gameEnded = true;
-                    break;
-                }
-                
-                if (strstr(currentResult.message, "It's our turn")) {
-                    itsOurTurn = true;
-                }
+            received[i] += length;
+            if (received[i] == sizeof(GameResult)) {
+                received[i] = 0;
+                results[completed++] = pending[i];
             }
         }
-        
-        cleanupMoveResult(&currentResult);
-        
-        if (itsOurTurn && !gameEnded && gameRunning) {
-            updateBoardState(&gameState);
-            
-            if (gameState.wagonsLeft <= 0) {
-                gameState.lastTurn = 1;
-            }
-            
-            if (turnCounter % 10 == 0 || gameState.lastTurn) {
-                printf("Game %d Turn %d - Wagons: Us=%d, Opp=%d%s\n", 
-                       gameNumber, turnCounter, gameState.wagonsLeft, gameState.opponentWagonsLeft,
-                       gameState.lastTurn ? " [LAST TURN]" : "");
-            }
-            
-            if (strlen(lastErrorMessage) > 0 && 
-                (strstr(lastErrorMessage, "Total score:") != NULL ||
-                 strstr(lastErrorMessage, "Georges:") != NULL)) {
-                gameRunning = false;
-                gameEnded = true;
+    }
+    
+    while (wait(NULL) > 0) {
+    }
+    free(pipes);
+    free(pending);
+    free(received);
+    return completed;
+}
+
+// -n games, -p games in flight, -l those games multiplexed over the line protocol of
+// t2rserver, -w its decision threads, -s host:port, -c one connection per game,
+// -r trace to record the API calls to, -R trace to replay instead of the server,
+// -M file to write the map of the games to, in the format of bookgen
+static int parseOptions(int argc, char** argv, SessionConfig* config, char* host, int hostSize,
+                        const char** recordPath, const char** replayPath, const char** mapPath) {
+    int opt;
+    while ((opt = getopt(argc, argv, "n:p:lw:s:cr:R:M:")) != -1) {
+        switch (opt) {
+            case 'n':
+                config->nbGames = atoi(optarg);
                 break;
-            }
-            
-            ResultCode playCode;
-            
-            if (firstTurn) {
-                playCode = playFirstTurn(&gameState);
-                if (playCode == ALL_GOOD) {
-                    firstTurn = false;
-                }
-            } else {
-                playCode = playTurn(&gameState);
-            }
-            
-            if (playCode == ALL_GOOD) {
-                consecutiveErrors = 0;
-                
-                if (gameState.lastTurn == 2) {
-                    gameRunning = false;
-                    gameEnded = true;
-                    break;
-                }
-                
-                if (gameState.wagonsLeft <= 2) {
-                    gameState.lastTurn = 1;
-                }
-                
-                if (gameState.wagonsLeft <= 0) {
-                    MoveResult immediateCheck = {0};
-                    ResultCode immediateCode = getMove(&dummyMove, &immediateCheck);
-                    (void)immediateCode;
-                    
-                    if (immediateCheck.state != 0) {
-                        if (immediateCheck.message) {
-                            strncpy(lastErrorMessage, immediateCheck.message, sizeof(lastErrorMessage)-1);
-                        }
-                        cleanupMoveResult(&immediateCheck);
-                        gameRunning = false;
-                        gameEnded = true;
-                        break;
-                    }
-                    
-                    if (immediateCheck.message && isGameOver(immediateCheck.message)) {
-                        strncpy(lastErrorMessage, immediateCheck.message, sizeof(lastErrorMessage)-1);
-                        cleanupMoveResult(&immediateCheck);
-                        gameRunning = false;
-                        gameEnded = true;
-                        break;
-                    }
-                    
-                    cleanupMoveResult(&immediateCheck);
-                }
-            } 
-            else {
-                MoveResult errorResult = {0};
-                ResultCode errorCode = getMove(&dummyMove, &errorResult);
-                (void)errorCode;
-                
-                if (errorResult.state != 0) {
-                    if (errorResult.message) {
-                        strncpy(lastErrorMessage, errorResult.message, sizeof(lastErrorMessage)-1);
-                    }
-                    cleanupMoveResult(&errorResult);
-                    gameRunning = false;
-                    gameEnded = true;
-                    break;
-                }
-                
-                if (errorResult.message) {
-                    if (strstr(errorResult.message, "Bad protocol") && 
-                        strstr(errorResult.message, "WAIT_GAME")) {
-                        cleanupMoveResult(&errorResult);
-                        
-                        consecutiveErrors++;
-                        if (consecutiveErrors > 10) {
-                            gameRunning = false;
-                        }
-                        continue;
-                    }
-                    
-                    if (isGameOver(errorResult.message)) {
-                        strncpy(lastErrorMessage, errorResult.message, sizeof(lastErrorMessage)-1);
-                        cleanupMoveResult(&errorResult);
-                        
-                        gameRunning = false;
-                        gameEnded = true;
-                        break;
-                    }
-                    
-                    strncpy(lastErrorMessage, errorResult.message, sizeof(lastErrorMessage)-1);
-                }
-                
-                cleanupMoveResult(&errorResult);
-                
-                consecutiveErrors++;
-                if (consecutiveErrors > 10) {
-                    gameRunning = false;
+            case 'p':
+                config->nbParallel = atoi(optarg);
+                break;
+            case 'l':
+                config->lineProtocol = 1;
+                break;
+            case 'w':
+                config->nbWorkers = atoi(optarg);
+                break;
+            case 's': {
+                char* colon = strrchr(optarg, ':');
+                if (!colon || colon == optarg || colon - optarg >= hostSize) {
+                    return 0;
                 }
+                memcpy(host, optarg, colon - optarg);
+                host[colon - optarg] = '\0';
+                config->host = host;
+                config->port = atoi(colon + 1);
+                break;
             }
-        }
-        
-        if (turnCounter >= MAX_TURNS) {
-            gameRunning = false;
+            case 'c':
+                config->reconnect = 1;
+                break;
+            case 'r':
+                *recordPath = optarg;
+                break;
+            case 'R':
+                *replayPath = optarg;
+                break;
+            case 'M':
+                *mapPath = optarg;
+                break;
+            default:
+                return 0;
         }
     }
     
-    int finalScore = calculateScore(&gameState);
-    
-    int completedObjectives = 0;
-    for (int i = 0; i < gameState.nbObjectives; i++) {
-        if (isObjectiveCompleted(&gameState, gameState.objectives[i])) {
-            completedObjectives++;
-        }
+    // Traces and the map dump cover the sequential client API only
+    if (*recordPath || *replayPath || *mapPath) {
+        config->nbParallel = 0;
     }
-    
-    char finalResultsMessage[2048] = {0};
-    bool hasServerResults = false;
-    
-    if (strlen(lastErrorMessage) > 0) {
-        strncpy(finalResultsMessage, lastErrorMessage, sizeof(finalResultsMessage)-1);
-        hasServerResults = true;
-    } else {
-        snprintf(finalResultsMessage, sizeof(finalResultsMessage),
-                "Game %d final score: %d\nWagons left: %d\nObjectives completed: %d/%d\n",
-                gameNumber, finalScore, gameState.wagonsLeft, 
-                completedObjectives, gameState.nbObjectives);
-        hasServerResults = false;
+    return config->nbGames > 0 && config->nbGames <= MAX_SESSION_GAMES && config->nbParallel >= 0 &&
+           !(*recordPath && *replayPath);
+}
+
+int main(int argc, char** argv) {
+    char host[256];
+    SessionConfig config = {SERVER_ADDRESS, SERVER_PORT, PLAYER_NAME, GAME_SETTINGS, NUMBER_OF_GAMES, 0, 0, 4, 0};
+    const char* recordPath = NULL;
+    const char* replayPath = NULL;
+    const char* mapPath = NULL;
+    if (!parseOptions(argc, argv, &config, host, sizeof(host), &recordPath, &replayPath, &mapPath)) {
+        printf("Usage: %s [-n games] [-p parallel games [-l] [-w workers]] [-s host:port] [-c] [-r trace | -R trace] [-M map]\n", argv[0]);
+        return 1;
     }
     
-    printGameResult(gameNumber, finalScore, finalResultsMessage, hasServerResults);
+    if ((recordPath && !startRecording(recordPath)) || (replayPath && !startReplay(replayPath)) ||
+        (mapPath && !startMapDump(mapPath))) {
+        return 1;
+    }
     
-    gameResult->gameNumber = gameNumber;
-    gameResult->finalScore = finalScore;
-    gameResult->wagonsLeft = gameState.wagonsLeft;
-    gameResult->objectivesCompleted = completedObjectives;
-    gameResult->totalObjectives = gameState.nbObjectives;
-    gameResult->hasServerResults = hasServerResults;
+    printf("=== Ticket to Ride AI Multi-Game Session ===\n");
+    printf("Playing %d games against NICE_BOT\n\n", config.nbGames);
     
-    if (hasServerResults) {
-        strncpy(gameResult->serverResults, lastErrorMessage, sizeof(gameResult->serverResults)-1);
+    if (loadOpeningBook(OPENING_BOOK_FILE)) {
+        printf("Opening book %s loaded\n\n", OPENING_BOOK_FILE);
     } else {
-        snprintf(gameResult->serverResults, sizeof(gameResult->serverResults),
-                "Game %d final score: %d\nWagons left: %d\nObjectives: %d/%d",
-                gameNumber, finalScore, gameState.wagonsLeft, 
-                completedObjectives, gameState.nbObjectives);
+        printf("No opening book, openings analysed live\n\n");
     }
     
-    if (gameData.gameName) free(gameData.gameName);
-    if (gameData.trackData) free(gameData.trackData);
-    
-    quitGame();
-    
-    sleep(1);
-    
-    return 0;
-}
-
-int main() {
-    printf("=== Ticket to Ride AI Multi-Game Session ===\n");
-    printf("Playing %d games against NICE_BOT\n\n", NUMBER_OF_GAMES);
-    
-    GameResult gameResults[NUMBER_OF_GAMES];
+    GameResult* gameResults = malloc(sizeof(GameResult) * config.nbGames);
+    if (!gameResults) {
+        return 1;
+    }
     int successfulGames = 0;
     
-    for (int gameNum = 1; gameNum <= NUMBER_OF_GAMES; gameNum++) {
-        int result = playOneGame(gameNum, &gameResults[successfulGames]);
-        
-        if (result == 0) {
-            successfulGames++;
+    if (config.nbParallel > 0 && config.lineProtocol) {
+        // All games at once over non-blocking sockets, decisions on the worker pool
+        successfulGames = runSessions(&config, gameResults);
+    } else if (config.nbParallel > 0) {
+        successfulGames = runProcesses(&config, gameResults);
+    } else {
+        bool connected = false;
+        for (int gameNum = 1; gameNum <= config.nbGames; gameNum++) {
+            int result = playOneGame(gameNum, &config, &connected, &gameResults[successfulGames]);
+            
+            if (result == 0) {
+                successfulGames++;
+            } else if (replayFinished()) {
+                break;
+            }
+            
+            printf("\n");
         }
         
-        printf("\n");
+        if (connected) {
+            tracedQuit();
+        }
     }
     
     printf("\n========================================\n");
     printf("           FINAL SESSION SUMMARY\n");
     printf("========================================\n");
-    printf("Games completed: %d/%d\n\n", successfulGames, NUMBER_OF_GAMES);
+    printf("Games completed: %d/%d\n\n", successfulGames, config.nbGames);
     
     if (successfulGames > 0) {
         int totalScore = 0;
         int totalObjectives = 0;
         int totalObjectivesCompleted = 0;
         int gamesWithServerResults = 0;
+        int gamesWon = 0;
         
         for (int i = 0; i < successfulGames; i++) {
             GameResult* gr = &gameResults[i];
+            const PlayerResult* opponent = gr->hasServerResults ? bestOpponent(gr, config.playerName) : NULL;
             
-            printf("Game %d: Score=%d, Objectives=%d/%d, Wagons left=%d %s\n", 
+            printf("Game %d: Score=%d, Objectives=%d/%d, Wagons left=%d %s", 
                    gr->gameNumber, gr->finalScore, gr->objectivesCompleted,
                    gr->totalObjectives, gr->wagonsLeft,
                    gr->hasServerResults ? "[Server Results]" : "[Local Only]");
+            if (opponent) {
+                printf(" vs %s %d%s", opponent->name, opponent->score, opponent->longestPath ? " (longest path)" : "");
+                gamesWon += gr->finalScore > opponent->score;
+            }
+            printf("\n");
             
             totalScore += gr->finalScore;
             totalObjectivesCompleted += gr->objectivesCompleted;
@@ -423,8 +454,16 @@ int main() {
         printf("Server results captured: %d/%d games (%.1f%%)\n", 
                gamesWithServerResults, successfulGames,
                (float)gamesWithServerResults / successfulGames * 100);
+        if (gamesWithServerResults > 0) {
+            printf("Games won: %d/%d\n", gamesWon, gamesWithServerResults);
+        }
     }
     
+    free(gameResults);
+    closeOpeningBook();
+    stopTrace();
+    stopMapDump();
+    
     printf("\nSession completed!\n");
     return 0;
 }
\ No newline at end of file
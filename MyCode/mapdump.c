@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "mapdump.h"
+#include "engine.h"
+
+// Like the trace, one dump per process
+static FILE* dumpFile = NULL;
+static const char* dumpPath = NULL;
+static uint64_t dumpedMap = 0;
+static Objective dumpedTickets[ENGINE_MAX_TICKETS];
+static int nbDumpedTickets = 0;
+
+int startMapDump(const char* path) {
+    dumpFile = fopen(path, "w");
+    if (!dumpFile) {
+        printf("Cannot write map dump %s\n", path);
+        return 0;
+    }
+    dumpPath = path;
+    return 1;
+}
+
+void stopMapDump(void) {
+    if (dumpFile) {
+        fclose(dumpFile);
+    }
+    dumpFile = NULL;
+    dumpedMap = 0;
+    nbDumpedTickets = 0;
+}
+
+// Flushed line by line: an interrupted session still leaves a usable file
+static void flushDump(void) {
+    if (fflush(dumpFile) != 0 || ferror(dumpFile)) {
+        printf("Map dump: write failed, dump stopped\n");
+        stopMapDump();
+    }
+}
+
+// A new map starts the file over: its tickets would not fit the old routes
+void dumpGameMap(const GameState* state) {
+    if (!dumpFile || state->mapHash == dumpedMap) {
+        return;
+    }
+    
+    if (dumpedMap != 0) {
+        printf("Map dump: the map changed, %s starts over\n", dumpPath);
+        dumpFile = freopen(dumpPath, "w", dumpFile);
+        if (!dumpFile) {
+            printf("Cannot write map dump %s\n", dumpPath);
+            return;
+        }
+    }
+    dumpedMap = state->mapHash;
+    nbDumpedTickets = 0;
+    
+    fprintf(dumpFile, "# map %016llx\n", (unsigned long long)state->mapHash);
+    fprintf(dumpFile, "cities %d\n", state->nbCities);
+    for (int i = 0; i < state->nbTracks; i++) {
+        const Route* route = &state->routes[i];
+        fprintf(dumpFile, "route %d %d %d %d %d\n", route->from, route->to, route->length,
+                route->color, route->secondColor);
+    }
+    flushDump();
+}
+
+void dumpTickets(const Objective* objectives, int count) {
+    if (!dumpFile) {
+        return;
+    }
+    
+    for (int i = 0; i < count && nbDumpedTickets < ENGINE_MAX_TICKETS; i++) {
+        int seen = 0;
+        for (int k = 0; k < nbDumpedTickets && !seen; k++) {
+            seen = memcmp(&dumpedTickets[k], &objectives[i], sizeof(Objective)) == 0;
+        }
+        if (seen) {
+            continue;
+        }
+        
+        dumpedTickets[nbDumpedTickets++] = objectives[i];
+        fprintf(dumpFile, "ticket %u %u %u\n", objectives[i].from, objectives[i].to, objectives[i].score);
+    }
+    flushDump();
+}
\ No newline at end of file
@@ -0,0 +1,14 @@
+#ifndef MAPDUMP_H
+#define MAPDUMP_H
+#include "gamestate.h"
+#include "../tickettorideapi/ticketToRide.h"
+
+// Map of the games played, written in the text format of bookgen and the engine
+// (cities, route, ticket lines), so a book can be built for the server's own map.
+// Routes are written once per map, in the server's order; tickets as they are offered.
+int startMapDump(const char* path);
+void stopMapDump(void);
+void dumpGameMap(const GameState* state);
+void dumpTickets(const Objective* objectives, int count);
+
+#endif
\ No newline at end of file
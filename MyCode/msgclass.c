@@ -0,0 +1,225 @@
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+#include "msgclass.h"
+
+#define AUTOMATON_MAX_STATES 256  // room for the fixed patterns below
+
+typedef enum {
+    PATTERN_TOTAL_SCORE,
+    PATTERN_OBJECTIVE_DONE,
+    PATTERN_OBJECTIVE_FAILED,
+    PATTERN_LONGEST_PATH,
+    PATTERN_GET_ERROR,
+    PATTERN_SEND_ERROR,
+    PATTERN_BAD_PROTOCOL,
+    PATTERN_WAIT_GAME,
+    PATTERN_OUR_TURN,
+    PATTERN_COUNT
+} Pattern;
+
+static const char* patterns[PATTERN_COUNT] = {
+    [PATTERN_TOTAL_SCORE] = "Total score:",
+    [PATTERN_OBJECTIVE_DONE] = "✔Objective",
+    [PATTERN_OBJECTIVE_FAILED] = "✘Objective",
+    [PATTERN_LONGEST_PATH] = " has the longest path",
+    [PATTERN_GET_ERROR] = "[getCGSMove]",
+    [PATTERN_SEND_ERROR] = "[sendCGSMove]",
+    [PATTERN_BAD_PROTOCOL] = "Bad protocol",
+    [PATTERN_WAIT_GAME] = "WAIT_GAME",
+    [PATTERN_OUR_TURN] = "It's our turn",
+};
+
+#define BIT(pattern) (1u << (pattern))
+#define END_OF_GAME (BIT(PATTERN_TOTAL_SCORE) | BIT(PATTERN_OBJECTIVE_DONE) | \
+                     BIT(PATTERN_OBJECTIVE_FAILED) | BIT(PATTERN_LONGEST_PATH))
+
+// Aho-Corasick automaton, failure links folded into a full transition table
+static unsigned char transitions[AUTOMATON_MAX_STATES][256];
+static unsigned int outputs[AUTOMATON_MAX_STATES];  // patterns ending in each state
+static pthread_once_t automatonOnce = PTHREAD_ONCE_INIT;
+
+static void buildAutomaton(void) {
+    int nbStates = 1;
+    for (int p = 0; p < PATTERN_COUNT; p++) {
+        int state = 0;
+        for (const unsigned char* c = (const unsigned char*)patterns[p]; *c; c++) {
+            if (!transitions[state][*c]) {
+                transitions[state][*c] = nbStates++;
+            }
+            state = transitions[state][*c];
+        }
+        outputs[state] |= BIT(p);
+    }
+    
+    // Breadth first, so the failure state of a node is complete before the node
+    int fail[AUTOMATON_MAX_STATES] = {0};
+    int queue[AUTOMATON_MAX_STATES];
+    int head = 0;
+    int tail = 0;
+    queue[tail++] = 0;
+    
+    while (head < tail) {
+        int state = queue[head++];
+        for (int c = 0; c < 256; c++) {
+            int next = transitions[state][c];
+            if (next) {
+                fail[next] = state == 0 ? 0 : transitions[fail[state]][c];
+                outputs[next] |= outputs[fail[next]];
+                queue[tail++] = next;
+            } else if (state != 0) {
+                transitions[state][c] = transitions[fail[state]][c];
+            }
+        }
+    }
+}
+
+// Patterns found up to the end of the text, the stop byte or limit bytes; matchEnd[p] is the offset just past the first p
+static unsigned int scanText(const char* text, int limit, char stop, int* matchEnd, int* length) {
+    pthread_once(&automatonOnce, buildAutomaton);
+    
+    unsigned int found = 0;
+    int state = 0;
+    int i = 0;
+    for (; i < limit && text[i] && text[i] != stop; i++) {
+        state = transitions[state][(unsigned char)text[i]];
+        unsigned int fresh = outputs[state] & ~found;
+        if (fresh && matchEnd) {
+            for (int p = 0; p < PATTERN_COUNT; p++) {
+                if (fresh & BIT(p)) {
+                    matchEnd[p] = i + 1;
+                }
+            }
+        }
+        found |= fresh;
+    }
+    
+    if (length) {
+        *length = i;
+    }
+    return found;
+}
+
+static MessageKind kindOf(unsigned int found) {
+    if (found & END_OF_GAME) {
+        return MESSAGE_GAME_OVER;
+    }
+    if ((found & BIT(PATTERN_BAD_PROTOCOL)) && (found & BIT(PATTERN_WAIT_GAME))) {
+        return MESSAGE_NO_GAME;
+    }
+    if (found & (BIT(PATTERN_GET_ERROR) | BIT(PATTERN_SEND_ERROR))) {
+        return MESSAGE_API_ERROR;
+    }
+    if (found & BIT(PATTERN_OUR_TURN)) {
+        return MESSAGE_OUR_TURN;
+    }
+    return MESSAGE_OTHER;
+}
+
+MessageKind classifyMessage(const char* message) {
+    if (!message) {
+        return MESSAGE_OTHER;
+    }
+    return kindOf(scanText(message, INT_MAX, '\0', NULL, NULL));
+}
+
+// Same for a payload seen in place in a receive buffer, not NUL-terminated
+MessageKind classifyPayload(const char* payload, int length) {
+    if (!payload) {
+        return MESSAGE_OTHER;
+    }
+    return kindOf(scanText(payload, length, '\0', NULL, NULL));
+}
+
+// Player named by the text before a pattern, "Name:" or "Player Name"
+static PlayerResult* resultPlayer(MatchResults* results, const char* name, int length) {
+    while (length > 0 && (name[length - 1] == ' ' || name[length - 1] == ':')) {
+        length--;
+    }
+    if (length <= 0) {
+        return NULL;
+    }
+    if (length >= RESULT_NAME_MAX) {
+        length = RESULT_NAME_MAX - 1;
+    }
+    
+    for (int i = 0; i < results->nbPlayers; i++) {
+        if (strncmp(results->players[i].name, name, length) == 0 && results->players[i].name[length] == '\0') {
+            return &results->players[i];
+        }
+    }
+    
+    if (results->nbPlayers == RESULT_MAX_PLAYERS) {
+        return NULL;
+    }
+    PlayerResult* player = &results->players[results->nbPlayers++];
+    memcpy(player->name, name, length);
+    player->name[length] = '\0';
+    return player;
+}
+
+static void parseResultLine(const char* line, unsigned int found, const int* matchEnd, MatchResults* results) {
+    if (found & BIT(PATTERN_TOTAL_SCORE)) {
+        int nameLength = matchEnd[PATTERN_TOTAL_SCORE] - (int)strlen(patterns[PATTERN_TOTAL_SCORE]);
+        PlayerResult* player = resultPlayer(results, line, nameLength);
+        if (player) {
+            player->score = atoi(line + matchEnd[PATTERN_TOTAL_SCORE]);
+        }
+    } else if (found & (BIT(PATTERN_OBJECTIVE_DONE) | BIT(PATTERN_OBJECTIVE_FAILED))) {
+        Pattern pattern = (found & BIT(PATTERN_OBJECTIVE_DONE)) ? PATTERN_OBJECTIVE_DONE : PATTERN_OBJECTIVE_FAILED;
+        PlayerResult* player = resultPlayer(results, line, matchEnd[pattern] - (int)strlen(patterns[pattern]));
+        if (player && pattern == PATTERN_OBJECTIVE_DONE) {
+            player->objectivesDone++;
+        } else if (player) {
+            player->objectivesFailed++;
+        }
+    } else if (found & BIT(PATTERN_LONGEST_PATH)) {
+        int nameStart = strncmp(line, "Player ", 7) == 0 ? 7 : 0;
+        int nameLength = matchEnd[PATTERN_LONGEST_PATH] - (int)strlen(patterns[PATTERN_LONGEST_PATH]) - nameStart;
+        PlayerResult* player = resultPlayer(results, line + nameStart, nameLength);
+        if (player) {
+            player->longestPath = 1;
+        }
+    }
+}
+
+// Number of players found in an end-of-game message
+int parseMatchResults(const char* message, MatchResults* results) {
+    memset(results, 0, sizeof(MatchResults));
+    if (!message) {
+        return 0;
+    }
+    
+    const char* line = message;
+    while (*line) {
+        int matchEnd[PATTERN_COUNT];
+        int length;
+        unsigned int found = scanText(line, INT_MAX, '\n', matchEnd, &length);
+        parseResultLine(line, found, matchEnd, results);
+        
+        line += length;
+        if (*line == '\n') {
+            line++;
+        }
+    }
+    return results->nbPlayers;
+}
+
+// The server may shorten names, so a prefix either way also matches
+const PlayerResult* findPlayerResult(const MatchResults* results, const char* playerName) {
+    for (int i = 0; i < results->nbPlayers; i++) {
+        if (strcmp(results->players[i].name, playerName) == 0) {
+            return &results->players[i];
+        }
+    }
+    
+    int nameLength = strlen(playerName);
+    for (int i = 0; i < results->nbPlayers; i++) {
+        int length = strlen(results->players[i].name);
+        if (strncmp(results->players[i].name, playerName, length < nameLength ? length : nameLength) == 0) {
+            return &results->players[i];
+        }
+    }
+    return NULL;
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#ifndef MSGCLASS_H
+#define MSGCLASS_H
+
+// Server messages, recognised in one pass by a multi-pattern automaton
+#define RESULT_NAME_MAX 32
+#define RESULT_MAX_PLAYERS 4
+
+typedef enum {
+    MESSAGE_OTHER,
+    MESSAGE_OUR_TURN,    // asked for the opponent's move while we must play
+    MESSAGE_NO_GAME,     // the server has no game running for us anymore
+    MESSAGE_API_ERROR,   // client API failure reported in the message
+    MESSAGE_GAME_OVER    // final scores
+} MessageKind;
+
+typedef struct {
+    char name[RESULT_NAME_MAX];
+    int score;
+    int objectivesDone;
+    int objectivesFailed;
+    int longestPath;     // 1 when this player got the longest path bonus
+} PlayerResult;
+
+// End-of-game summary as announced by the server
+typedef struct {
+    int nbPlayers;
+    PlayerResult players[RESULT_MAX_PLAYERS];
+} MatchResults;
+
+MessageKind classifyMessage(const char* message);
+MessageKind classifyPayload(const char* payload, int length);
+int parseMatchResults(const char* message, MatchResults* results);
+const PlayerResult* findPlayerResult(const MatchResults* results, const char* playerName);
+
+#endif
\ No newline at end of file
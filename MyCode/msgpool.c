@@ -0,0 +1,57 @@
+#include <stdlib.h>
+#include <string.h>
+#include "msgpool.h"
+
+int initMessagePool(MessagePool* pool, int capacity) {
+    memset(pool, 0, sizeof(MessagePool));
+    pool->slab = malloc(sizeof(MessageBuffer) * capacity);
+    if (!pool->slab) {
+        return 0;
+    }
+    
+    pool->capacity = capacity;
+    for (int i = capacity - 1; i >= 0; i--) {
+        pool->slab[i].next = pool->free;
+        pool->free = &pool->slab[i];
+    }
+    return 1;
+}
+
+void freeMessagePool(MessagePool* pool) {
+    free(pool->slab);
+    memset(pool, 0, sizeof(MessagePool));
+}
+
+// NULL once every buffer is out; sized so each session can hold one
+MessageBuffer* borrowMessage(MessagePool* pool) {
+    MessageBuffer* buffer = pool->free;
+    if (!buffer) {
+        return NULL;
+    }
+    
+    pool->free = buffer->next;
+    pool->borrowed++;
+    buffer->next = NULL;
+    buffer->length = 0;
+    buffer->data[0] = '\0';
+    return buffer;
+}
+
+void returnMessage(MessagePool* pool, MessageBuffer* buffer) {
+    if (!buffer) {
+        return;
+    }
+    buffer->next = pool->free;
+    pool->free = buffer;
+    pool->borrowed--;
+}
+
+// Copies a payload seen in place in a receive buffer, truncated to the buffer size
+void setMessage(MessageBuffer* buffer, const char* text, int length) {
+    if (length > MESSAGE_BUFFER_SIZE - 1) {
+        length = MESSAGE_BUFFER_SIZE - 1;
+    }
+    memcpy(buffer->data, text, length);
+    buffer->data[length] = '\0';
+    buffer->length = length;
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+#ifndef MSGPOOL_H
+#define MSGPOOL_H
+
+// Fixed set of message buffers borrowed and returned by the sessions of one I/O loop.
+// All buffers come from one allocation made up front; no locking, one thread only.
+#define MESSAGE_BUFFER_SIZE 2048
+
+typedef struct MessageBuffer {
+    struct MessageBuffer* next;      // free list link while in the pool
+    int length;
+    char data[MESSAGE_BUFFER_SIZE];  // NUL-terminated
+} MessageBuffer;
+
+typedef struct {
+    MessageBuffer* slab;
+    MessageBuffer* free;
+    int capacity;
+    int borrowed;
+} MessagePool;
+
+int initMessagePool(MessagePool* pool, int capacity);
+void freeMessagePool(MessagePool* pool);
+MessageBuffer* borrowMessage(MessagePool* pool);
+void returnMessage(MessagePool* pool, MessageBuffer* buffer);
+void setMessage(MessageBuffer* buffer, const char* text, int length);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,212 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "opponent.h"
+#include "gamestate.h"
+
+void initOpponentModel(GameState* state) {
+    if (!state) {
+        return;
+    }
+    
+    memset(state->opponentKnownCards, 0, sizeof(state->opponentKnownCards));
+    memset(state->discardedCards, 0, sizeof(state->discardedCards));
+    
+    // Starting hand is dealt blind from the full deck
+    state->opponentUnknownCount = state->opponentCardCount;
+    for (int c = 0; c < 10; c++) {
+        state->opponentUnknownCards[c] = 0;
+    }
+    for (int c = PURPLE; c <= LOCOMOTIVE; c++) {
+        int total = (c == LOCOMOTIVE) ? LOCOMOTIVE_CARDS : CARDS_PER_COLOR;
+        state->opponentUnknownCards[c] = (float)state->opponentUnknownCount * total /
+                                         (8 * CARDS_PER_COLOR + LOCOMOTIVE_CARDS);
+    }
+}
+
+// Cards of this colour we cannot see: deck plus opponent's blind draws
+static float unseenCards(GameState* state, CardColor color) {
+    int total = (color == LOCOMOTIVE) ? LOCOMOTIVE_CARDS : CARDS_PER_COLOR;
+    
+    int visible = 0;
+    for (int i = 0; i < 5; i++) {
+        if (state->visibleCards[i] == color) {
+            visible++;
+        }
+    }
+    
+    float unseen = total - state->nbCardsByColor[color] - visible -
+                   state->opponentKnownCards[color] - state->discardedCards[color];
+    
+    return (unseen > 0) ? unseen : 0;
+}
+
+float deckColorProbability(GameState* state, CardColor color) {
+    if (!state || color < PURPLE || color > LOCOMOTIVE) {
+        return 0;
+    }
+    
+    float totalUnseen = 0;
+    for (int c = PURPLE; c <= LOCOMOTIVE; c++) {
+        totalUnseen += unseenCards(state, c);
+    }
+    
+    if (totalUnseen <= 0) {
+        return 0;
+    }
+    
+    return unseenCards(state, color) / totalUnseen;
+}
+
+void opponentDrewVisibleCard(GameState* state, CardColor card) {
+    if (!state || card < PURPLE || card > LOCOMOTIVE) {
+        return;
+    }
+    
+    state->opponentKnownCards[card]++;
+}
+
+void opponentDrewBlindCard(GameState* state) {
+    if (!state) {
+        return;
+    }
+    
+    // Spread the card over the deck posterior at draw time
+    for (int c = PURPLE; c <= LOCOMOTIVE; c++) {
+        state->opponentUnknownCards[c] += deckColorProbability(state, c);
+    }
+    state->opponentUnknownCount++;
+}
+
+// Takes up to count cards of one colour out of the blind part of the hand
+static void removeUnknownCards(GameState* state, CardColor color, int count) {
+    if (count <= 0 || state->opponentUnknownCount <= 0) {
+        return;
+    }
+    
+    if (count > state->opponentUnknownCount) {
+        count = state->opponentUnknownCount;
+    }
+    
+    state->opponentUnknownCards[color] -= count;
+    if (state->opponentUnknownCards[color] < 0) {
+        state->opponentUnknownCards[color] = 0;
+    }
+    state->opponentUnknownCount -= count;
+    
+    // Renormalise the remaining blind cards so they still sum to the count
+    float sum = 0;
+    for (int c = PURPLE; c <= LOCOMOTIVE; c++) {
+        sum += state->opponentUnknownCards[c];
+    }
+    
+    for (int c = PURPLE; c <= LOCOMOTIVE; c++) {
+        if (sum > 0) {
+            state->opponentUnknownCards[c] *= state->opponentUnknownCount / sum;
+        } else {
+            state->opponentUnknownCards[c] = 0;
+        }
+    }
+}
+
+void opponentUsedCards(GameState* state, CardColor color, int length, int nbLocomotives) {
+    if (!state || length <= 0 || color < PURPLE || color > LOCOMOTIVE) {
+        return;
+    }
+    
+    if (nbLocomotives < 0 || nbLocomotives > length) {
+        nbLocomotives = 0;
+    }
+    
+    int colorCards = (color == LOCOMOTIVE) ? 0 : length - nbLocomotives;
+    int locomotives = (color == LOCOMOTIVE) ? length : nbLocomotives;
+    
+    int fromKnown = (colorCards < state->opponentKnownCards[color]) ? colorCards : state->opponentKnownCards[color];
+    state->opponentKnownCards[color] -= fromKnown;
+    removeUnknownCards(state, color, colorCards - fromKnown);
+    
+    fromKnown = (locomotives < state->opponentKnownCards[LOCOMOTIVE]) ? locomotives : state->opponentKnownCards[LOCOMOTIVE];
+    state->opponentKnownCards[LOCOMOTIVE] -= fromKnown;
+    removeUnknownCards(state, LOCOMOTIVE, locomotives - fromKnown);
+    
+    state->discardedCards[color] += colorCards;
+    state->discardedCards[LOCOMOTIVE] += locomotives;
+}
+
+float opponentExpectedCards(GameState* state, CardColor color) {
+    if (!state || color < PURPLE || color > LOCOMOTIVE) {
+        return 0;
+    }
+    
+    return state->opponentKnownCards[color] + state->opponentUnknownCards[color];
+}
+
+// P(X >= k) for X ~ Binomial(n, p)
+static float binomialTail(int n, float p, int k) {
+    if (k <= 0) return 1;
+    if (k > n || p <= 0) return 0;
+    if (p >= 1) return 1;
+    
+    float term = 1;
+    for (int i = 0; i < n; i++) {
+        term *= (1 - p);
+    }
+    
+    float below = 0;
+    for (int i = 0; i < k; i++) {
+        below += term;
+        term *= (float)(n - i) / (i + 1) * p / (1 - p);
+    }
+    
+    float tail = 1 - below;
+    return (tail > 0) ? tail : 0;
+}
+
+// Probability the opponent holds enough cards of one colour (plus locomotives)
+static float colorClaimProbability(GameState* state, CardColor color, int length) {
+    int known = state->opponentKnownCards[LOCOMOTIVE];
+    float expectedUnknown = state->opponentUnknownCards[LOCOMOTIVE];
+    
+    if (color != LOCOMOTIVE) {
+        known += state->opponentKnownCards[color];
+        expectedUnknown += state->opponentUnknownCards[color];
+    }
+    
+    int n = state->opponentUnknownCount;
+    float p = (n > 0) ? expectedUnknown / n : 0;
+    
+    return binomialTail(n, p, length - known);
+}
+
+float opponentClaimProbability(GameState* state, int routeIndex) {
+    if (!state || routeIndex < 0 || routeIndex >= state->nbTracks) {
+        return 0;
+    }
+    
+    Route* route = &state->routes[routeIndex];
+    if (route->owner != 0 || route->length > state->opponentWagonsLeft) {
+        return 0;
+    }
+    
+    if (route->color == LOCOMOTIVE) {
+        // Gray route: the opponent picks whichever colour they hold most of
+        float best = 0;
+        for (int c = PURPLE; c <= LOCOMOTIVE; c++) {
+            float p = colorClaimProbability(state, c, route->length);
+            if (p > best) {
+                best = p;
+            }
+        }
+        return best;
+    }
+    
+    float p = colorClaimProbability(state, route->color, route->length);
+    if (route->secondColor != NONE && route->secondColor != route->color) {
+        float p2 = colorClaimProbability(state, route->secondColor, route->length);
+        if (p2 > p) {
+            p = p2;
+        }
+    }
+    
+    return p;
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#ifndef OPPONENT_H
+#define OPPONENT_H
+#include "gamestate.h"
+#include "../tickettorideapi/ticketToRide.h"
+
+#define CARDS_PER_COLOR 12
+#define LOCOMOTIVE_CARDS 14
+
+void initOpponentModel(GameState* state);
+float deckColorProbability(GameState* state, CardColor color);
+void opponentDrewVisibleCard(GameState* state, CardColor card);
+void opponentDrewBlindCard(GameState* state);
+void opponentUsedCards(GameState* state, CardColor color, int length, int nbLocomotives);
+float opponentExpectedCards(GameState* state, CardColor color);
+float opponentClaimProbability(GameState* state, int routeIndex);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "pathcost.h"
+#include "strategy.h"
+#include "opponent.h"
+#include "contention.h"
+
+// Hand-aware costs are in tenths of a wagon, pure length in wagons
+#define COST_UNIT 10
+#define DRAW_TURN_COST 10
+#define COST_INF 999999
+
+int lengthEdgeCost(GameState* state, int routeIndex, void* ctx) {
+    (void)ctx;
+    int owner = state->routes[routeIndex].owner;
+    if (owner == 2) return EDGE_COST_BLOCKED;
+    if (owner == 1) return 0;
+    return state->routes[routeIndex].length;
+}
+
+void prepareHandCost(GameState* state, HandCostContext* ctx) {
+    float locoRate = deckColorProbability(state, LOCOMOTIVE);
+    
+    ctx->bestColor = PURPLE;
+    for (int c = PURPLE; c <= GREEN; c++) {
+        if (state->nbCardsByColor[c] > state->nbCardsByColor[ctx->bestColor]) {
+            ctx->bestColor = c;
+        }
+    }
+    
+    // Two blind draws a turn, or one visible card of the colour if it is showing
+    for (int c = PURPLE; c <= GREEN; c++) {
+        float rate = 2 * (deckColorProbability(state, c) + locoRate);
+        for (int i = 0; i < 5; i++) {
+            if ((int)state->visibleCards[i] == c) {
+                rate += 1;
+                break;
+            }
+        }
+        ctx->drawRate[c] = rate > 2 ? 2 : rate;
+    }
+    
+    // Grey routes take whichever colour turns up in quantity
+    float greyRate = ctx->drawRate[ctx->bestColor] + 0.5f;
+    ctx->drawRate[LOCOMOTIVE] = greyRate > 2 ? 2 : greyRate;
+    ctx->drawRate[NONE] = ctx->drawRate[LOCOMOTIVE];
+    
+    for (int r = 0; r < MAX_ROUTES; r++) {
+        ctx->cache[r] = -2;
+    }
+}
+
+// Wagons, plus the turns still needed to draw the missing cards,
+// plus the expected loss if the opponent takes it meanwhile
+int handAwareEdgeCost(GameState* state, int routeIndex, void* ctx) {
+    HandCostContext* hand = (HandCostContext*)ctx;
+    if (hand->cache[routeIndex] != -2) {
+        return hand->cache[routeIndex];
+    }
+    
+    Route* route = &state->routes[routeIndex];
+    int cost;
+    
+    if (route->owner == 2) {
+        cost = EDGE_COST_BLOCKED;
+    } else if (route->owner == 1) {
+        cost = 0;
+    } else {
+        int grey = (route->color == LOCOMOTIVE || route->color == NONE);
+        int color = grey ? hand->bestColor : (int)route->color;
+        int have = state->nbCardsByColor[color] + state->nbCardsByColor[LOCOMOTIVE];
+        int deficit = route->length - have;
+        if (deficit < 0) deficit = 0;
+        
+        float rate = hand->drawRate[grey ? LOCOMOTIVE : route->color];
+        if (rate < 0.3f) rate = 0.3f;
+        float drawTurns = deficit / rate;
+        
+        float risk = routeTakeRisk(state, routeIndex, (int)drawTurns + 1);
+        
+        cost = route->length * COST_UNIT + (int)(drawTurns * DRAW_TURN_COST) +
+               (int)(risk * route->length * COST_UNIT);
+    }
+    
+    hand->cache[routeIndex] = cost;
+    return cost;
+}
+
+// Dijkstra over the incidence lists, costs through the kernel's function pointer
+static int kernelSearch(GameState* state, int start, int end, int* path, int* pathLength,
+                        EdgeCostFn cost, void* ctx) {
+    int dist[MAX_CITIES];
+    int prev[MAX_CITIES];
+    int visited[MAX_CITIES];
+    
+    for (int i = 0; i < state->nbCities; i++) {
+        dist[i] = COST_INF;
+        prev[i] = -1;
+        visited[i] = 0;
+    }
+    dist[start] = 0;
+    
+    for (int count = 0; count < state->nbCities; count++) {
+        int u = -1;
+        for (int i = 0; i < state->nbCities; i++) {
+            if (!visited[i] && dist[i] < COST_INF && (u < 0 || dist[i] < dist[u])) {
+                u = i;
+            }
+        }
+        
+        if (u < 0) break;
+        visited[u] = 1;
+        if (u == end) break;
+        
+        for (int k = state->incidentStart[u]; k < state->incidentStart[u + 1]; k++) {
+            int r = state->incidentRoutes[k];
+            int c = cost(state, r, ctx);
+            if (c == EDGE_COST_BLOCKED) continue;
+            
+            int v = (state->routes[r].from == u) ? state->routes[r].to : state->routes[r].from;
+            if (dist[u] + c < dist[v]) {
+                dist[v] = dist[u] + c;
+                prev[v] = u;
+            }
+        }
+    }
+    
+    if (prev[end] == -1 && start != end) return -1;
+    
+    int tempPath[MAX_CITIES];
+    int tempIndex = 0;
+    for (int current = end; current != -1 && tempIndex < MAX_CITIES; current = prev[current]) {
+        tempPath[tempIndex++] = current;
+        if (current == start) break;
+    }
+    
+    *pathLength = tempIndex;
+    for (int i = 0; i < tempIndex; i++) {
+        path[i] = tempPath[tempIndex - 1 - i];
+    }
+    
+    return dist[end];
+}
+
+int findPathWithKernel(GameState* state, int start, int end, int* path, int* pathLength,
+                       const EdgeCostKernel* kernel) {
+    // Pure length: the existing search, costs in wagons
+    if (!kernel || !kernel->cost || kernel->cost == lengthEdgeCost) {
+        return findSmartestPath(state, start, end, path, pathLength);
+    }
+    
+    if (!state || !path || !pathLength || start < 0 || start >= state->nbCities ||
+        end < 0 || end >= state->nbCities) {
+        return -1;
+    }
+    
+    return kernelSearch(state, start, end, path, pathLength, kernel->cost, kernel->ctx);
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef PATHCOST_H
+#define PATHCOST_H
+#include "gamestate.h"
+#include "../tickettorideapi/ticketToRide.h"
+
+#define EDGE_COST_BLOCKED -1
+
+// Cost of using a route in a path search; EDGE_COST_BLOCKED removes it
+typedef int (*EdgeCostFn)(GameState* state, int routeIndex, void* ctx);
+
+typedef struct {
+    EdgeCostFn cost;
+    void* ctx;
+} EdgeCostKernel;
+
+// Hand snapshot for handAwareEdgeCost, prepared once per decision
+typedef struct {
+    float drawRate[10];       // useful cards per drawing turn, by route colour
+    int bestColor;            // colour we hold most of, for grey routes
+    int cache[MAX_ROUTES];    // -2 until computed
+} HandCostContext;
+
+int lengthEdgeCost(GameState* state, int routeIndex, void* ctx);
+int handAwareEdgeCost(GameState* state, int routeIndex, void* ctx);
+void prepareHandCost(GameState* state, HandCostContext* ctx);
+int findPathWithKernel(GameState* state, int start, int end, int* path, int* pathLength,
+                       const EdgeCostKernel* kernel);
+
+#endif
\ No newline at end of file
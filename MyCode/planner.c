@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include "planner.h"
+
+#define PLANNER_INF (INT_MAX / 4)
+// LPA* needs positive costs: our routes cost 1, free routes length * scale.
+// A shortest path is simple, so it has fewer than MAX_CITIES owned hops and
+// they always weigh less than one wagon: fewer wagons still wins, and g / scale
+// is the wagon count findSmartestPath gives.
+#define PLANNER_SCALE MAX_CITIES
+
+// Longest simple path of 6-wagon routes must stay below the blocked cost
+#if 6 * MAX_CITIES * PLANNER_SCALE >= PLANNER_INF
+#error "MAX_CITIES too large for the planner's integer costs"
+#endif
+
+static int routeCost(GameState* state, int routeIndex) {
+    int owner = state->routes[routeIndex].owner;
+    if (owner == 2) return PLANNER_INF;
+    if (owner == 1) return 1;
+    return state->routes[routeIndex].length * PLANNER_SCALE;
+}
+
+static int otherEnd(GameState* state, int routeIndex, int city) {
+    return state->routes[routeIndex].from == city ? state->routes[routeIndex].to : state->routes[routeIndex].from;
+}
+
+static int keyOf(ObjectivePlanner* planner, int city) {
+    return planner->g[city] < planner->rhs[city] ? planner->g[city] : planner->rhs[city];
+}
+
+static void updateVertex(GameState* state, ObjectivePlanner* planner, int city) {
+    if (city == planner->start) {
+        return;
+    }
+    
+    int best = PLANNER_INF;
+    for (int k = state->incidentStart[city]; k < state->incidentStart[city + 1]; k++) {
+        int r = state->incidentRoutes[k];
+        int cost = routeCost(state, r);
+        int u = otherEnd(state, r, city);
+        
+        if (cost == PLANNER_INF || planner->g[u] == PLANNER_INF) continue;
+        if (planner->g[u] + cost < best) {
+            best = planner->g[u] + cost;
+        }
+    }
+    planner->rhs[city] = best;
+}
+
+static void resetPlanner(GameState* state, ObjectivePlanner* planner, int start, int goal) {
+    for (int c = 0; c < MAX_CITIES; c++) {
+        planner->g[c] = PLANNER_INF;
+        planner->rhs[c] = PLANNER_INF;
+    }
+    planner->start = start;
+    planner->goal = goal;
+    planner->rhs[start] = 0;
+    planner->syncedChanges = state->nbRouteChanges;
+    planner->valid = 1;
+}
+
+// Only routes whose owner changed since the last call touch the search tree
+static void applyRouteChanges(GameState* state, ObjectivePlanner* planner) {
+    for (int i = planner->syncedChanges; i < state->nbRouteChanges; i++) {
+        int r = state->routeChangeLog[i];
+        updateVertex(state, planner, state->routes[r].from);
+        updateVertex(state, planner, state->routes[r].to);
+    }
+    planner->syncedChanges = state->nbRouteChanges;
+}
+
+// The queue is implicit: every locally inconsistent city (g != rhs)
+static int topInconsistent(GameState* state, ObjectivePlanner* planner) {
+    int best = -1;
+    for (int c = 0; c < state->nbCities; c++) {
+        if (planner->g[c] != planner->rhs[c] &&
+            (best < 0 || keyOf(planner, c) < keyOf(planner, best))) {
+            best = c;
+        }
+    }
+    return best;
+}
+
+static void computeShortestPath(GameState* state, ObjectivePlanner* planner) {
+    int goal = planner->goal;
+    
+    while (1) {
+        int u = topInconsistent(state, planner);
+        if (u < 0) break;
+        if (keyOf(planner, u) >= keyOf(planner, goal) && planner->g[goal] == planner->rhs[goal]) break;
+        
+        int overConsistent = planner->g[u] > planner->rhs[u];
+        planner->g[u] = overConsistent ? planner->rhs[u] : PLANNER_INF;
+        if (!overConsistent) {
+            updateVertex(state, planner, u);
+        }
+        
+        for (int k = state->incidentStart[u]; k < state->incidentStart[u + 1]; k++) {
+            updateVertex(state, planner, otherEnd(state, state->incidentRoutes[k], u));
+        }
+    }
+}
+
+int plannerPath(GameState* state, ObjectivePlanner* planner, int start, int goal, int* path, int* pathLength) {
+    if (!state || !planner || !path || !pathLength || start < 0 || start >= state->nbCities ||
+        goal < 0 || goal >= state->nbCities) {
+        return -1;
+    }
+    
+    if (!planner->valid || planner->start != start || planner->goal != goal ||
+        planner->syncedChanges > state->nbRouteChanges || state->nbRouteChanges >= MAX_ROUTES * 2) {
+        resetPlanner(state, planner, start, goal);
+    } else {
+        applyRouteChanges(state, planner);
+    }
+    
+    computeShortestPath(state, planner);
+    
+    if (planner->g[goal] == PLANNER_INF) {
+        return -1;
+    }
+    
+    // Breadth-first walk back over tight edges between consistent cities
+    int parent[MAX_CITIES];
+    int queue[MAX_CITIES];
+    int head = 0, tail = 0;
+    for (int c = 0; c < state->nbCities; c++) {
+        parent[c] = -2;
+    }
+    parent[goal] = -1;
+    queue[tail++] = goal;
+    
+    while (head < tail && parent[start] == -2) {
+        int v = queue[head++];
+        for (int k = state->incidentStart[v]; k < state->incidentStart[v + 1]; k++) {
+            int r = state->incidentRoutes[k];
+            int cost = routeCost(state, r);
+            int u = otherEnd(state, r, v);
+            
+            if (parent[u] != -2 || cost == PLANNER_INF || planner->g[u] != planner->rhs[u]) continue;
+            if (planner->g[u] + cost == planner->g[v]) {
+                parent[u] = v;
+                queue[tail++] = u;
+            }
+        }
+    }
+    
+    if (parent[start] == -2) {
+        return -1;
+    }
+    
+    int count = 0;
+    for (int c = start; c != -1 && count < MAX_CITIES; c = parent[c]) {
+        path[count++] = c;
+    }
+    *pathLength = count;
+    
+    return planner->g[goal] / PLANNER_SCALE;
+}
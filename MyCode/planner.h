@@ -0,0 +1,8 @@
+#ifndef PLANNER_H
+#define PLANNER_H
+#include "gamestate.h"
+#include "../tickettorideapi/ticketToRide.h"
+
+int plannerPath(GameState* state, ObjectivePlanner* planner, int start, int goal, int* path, int* pathLength);
+
+#endif
\ No newline at end of file
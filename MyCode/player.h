@@ -1,11 +1,19 @@
 #ifndef PLAYER_H
 #define PLAYER_H
 #include "gamestate.h"
+#include "strategy.h"
 #include "../tickettorideapi/ticketToRide.h"
 
-void initPlayer(GameState* state, GameData* gameData);
-ResultCode playTurn(GameState* state);
-ResultCode playFirstTurn(GameState* state);
+// Everything one game mutates, so several games can run in one process
+typedef struct {
+    GameState state;
+    StrategyContext strategy;
+    int cardDrawnThisTurn;  // first card of a two-card draw taken
+} GameContext;
+
+void initPlayer(GameContext* game, GameData* gameData);
+void prepareMove(GameContext* game, MoveData* myMove);
+void applyMoveResult(GameContext* game, const MoveData* myMove, const MoveResult* myMoveResult);
 void cleanupMoveResult(MoveResult *moveResult);
 
 #endif
\ No newline at end of file
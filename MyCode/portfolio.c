@@ -0,0 +1,358 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "portfolio.h"
+#include "rules.h"
+#include "reachability.h"
+
+#define INF_DIST 999999
+
+typedef struct {
+    unsigned char planned[MAX_ROUTES];  // free routes the plan will claim
+    int wagons;
+    int claims;
+    int routePoints;
+    float expectedObjectivePoints;
+} PortfolioPlan;
+
+int estimateTurnsLeft(GameState* state) {
+    // The opponent burns about 1.5 wagons per turn on average
+    int opponentTurns = (state->opponentWagonsLeft * 2) / 3 + 1;
+    int ourTurns = state->wagonsLeft;
+    
+    return (opponentTurns < ourTurns) ? opponentTurns : ourTurns;
+}
+
+// Cheapest path given the routes already in the plan; adds its new routes to it
+static int extendPlan(GameState* state, PortfolioPlan* plan, int start, int end) {
+    int dist[MAX_CITIES];
+    int prevRoute[MAX_CITIES];
+    int visited[MAX_CITIES];
+    
+    for (int i = 0; i < state->nbCities; i++) {
+        dist[i] = INF_DIST;
+        prevRoute[i] = -1;
+        visited[i] = 0;
+    }
+    dist[start] = 0;
+    
+    for (int count = 0; count < state->nbCities; count++) {
+        int u = -1;
+        int minDist = INF_DIST;
+        
+        for (int i = 0; i < state->nbCities; i++) {
+            if (!visited[i] && dist[i] < minDist) {
+                minDist = dist[i];
+                u = i;
+            }
+        }
+        
+        if (u == -1 || u == end) break;
+        visited[u] = 1;
+        
+        for (int i = 0; i < state->nbTracks; i++) {
+            if (state->routes[i].owner == 2) continue;
+            
+            int from = state->routes[i].from;
+            int to = state->routes[i].to;
+            if (from != u && to != u) continue;
+            
+            int v = (from == u) ? to : from;
+            int length = (state->routes[i].owner == 1 || plan->planned[i]) ? 0 : state->routes[i].length;
+            
+            if (dist[u] + length < dist[v]) {
+                dist[v] = dist[u] + length;
+                prevRoute[v] = i;
+            }
+        }
+    }
+    
+    if (dist[end] >= INF_DIST) {
+        return -1;
+    }
+    
+    int added = 0;
+    for (int city = end; city != start && prevRoute[city] >= 0; ) {
+        int r = prevRoute[city];
+        
+        if (state->routes[r].owner == 0 && !plan->planned[r]) {
+            plan->planned[r] = 1;
+            plan->wagons += state->routes[r].length;
+            plan->claims++;
+            plan->routePoints += routePointsForLength(state->routes[r].length);
+            added += state->routes[r].length;
+        }
+        
+        city = (state->routes[r].from == city) ? state->routes[r].to : state->routes[r].from;
+    }
+    
+    return added;
+}
+
+// Turns to build a plan: one per claim plus draw turns, about a third of
+// drawn cards being the wrong colour
+static int turnsForPlan(GameState* state, PortfolioPlan* plan) {
+    int cardsNeeded = plan->wagons - state->nbCards;
+    if (cardsNeeded < 0) cardsNeeded = 0;
+    
+    return plan->claims + (cardsNeeded * 3 + 3) / 4;
+}
+
+static float completionProbability(GameState* state, PortfolioPlan* plan, int horizon) {
+    if (plan->wagons > state->wagonsLeft) {
+        return 0;
+    }
+    
+    int turns = turnsForPlan(state, plan);
+    if (horizon <= 0) {
+        return (turns == 0) ? 1.0f : 0;
+    }
+    
+    float ratio = (float)turns / horizon;
+    if (ratio <= 0.5f) return 0.9f;
+    if (ratio >= 1.1f) return 0.05f;
+    
+    return 0.9f - (ratio - 0.5f) / 0.6f * 0.85f;
+}
+
+static void addObjectiveToPlan(GameState* state, PortfolioPlan* plan, Objective objective, int horizon) {
+    int score = (int)objective.score;
+    
+    // Already connected: the points are banked, whatever the rest of the plan does
+    if (isObjectiveCompleted(state, objective)) {
+        plan->expectedObjectivePoints += score;
+        return;
+    }
+    
+    
+    if (!isObjectiveReachable(state, objective) ||
+        extendPlan(state, plan, objective.from, objective.to) < 0) {
+        plan->expectedObjectivePoints -= score;
+        return;
+    }
+    
+    // Tickets are added by priority, so later ones wait for earlier ones
+    float p = completionProbability(state, plan, horizon);
+    plan->expectedObjectivePoints += score * p - score * (1 - p);
+}
+
+static float planValue(GameState* state, PortfolioPlan* plan, int horizon) {
+    float p = completionProbability(state, plan, horizon);
+    
+    return plan->expectedObjectivePoints + plan->routePoints * (p > 0.5f ? p : 0.5f);
+}
+
+static int sortByScore(Objective* objectives, int* order, int count) {
+    for (int i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    
+    for (int i = 1; i < count; i++) {
+        int key = order[i];
+        int j = i - 1;
+        while (j >= 0 && objectives[order[j]].score < objectives[key].score) {
+            order[j + 1] = order[j];
+            j--;
+        }
+        order[j + 1] = key;
+    }
+    
+    return count;
+}
+
+// DP over keep-sets: plan[mask] extends plan[mask without its top ticket]
+static void buildPlans(GameState* state, Objective* candidates, int count, PortfolioPlan* plans) {
+    int horizon = estimateTurnsLeft(state);
+    
+    memset(&plans[0], 0, sizeof(PortfolioPlan));
+    
+    // Tickets we already hold come first, highest score first
+    int heldOrder[MAX_OBJECTIVES];
+    sortByScore(state->objectives, heldOrder, state->nbObjectives);
+    for (int i = 0; i < state->nbObjectives; i++) {
+        addObjectiveToPlan(state, &plans[0], state->objectives[heldOrder[i]], horizon);
+    }
+    
+    int order[MAX_CANDIDATES];
+    sortByScore(candidates, order, count);
+    
+    for (int mask = 1; mask < (1 << count); mask++) {
+        int top = -1;
+        for (int k = count - 1; k >= 0; k--) {
+            if (mask & (1 << order[k])) {
+                top = k;
+                break;
+            }
+        }
+        
+        int parent = mask & ~(1 << order[top]);
+        plans[mask] = plans[parent];
+        addObjectiveToPlan(state, &plans[mask], candidates[order[top]], horizon);
+    }
+}
+
+float evaluatePortfolio(GameState* state, Objective* candidates, int count, int keepMask) {
+    if (!state || !candidates || count <= 0 || count > MAX_CANDIDATES) {
+        return 0;
+    }
+    
+    PortfolioPlan plans[1 << MAX_CANDIDATES];
+    buildPlans(state, candidates, count, plans);
+    
+    return planValue(state, &plans[keepMask], estimateTurnsLeft(state));
+}
+
+int choosePortfolio(GameState* state, Objective* candidates, int count, unsigned char* chooseObjectives) {
+    if (!state || !candidates || !chooseObjectives || count <= 0 || count > MAX_CANDIDATES) {
+        return 0;
+    }
+    
+    PortfolioPlan plans[1 << MAX_CANDIDATES];
+    buildPlans(state, candidates, count, plans);
+    
+    int horizon = estimateTurnsLeft(state);
+    int minKeep = (state->nbObjectives == 0 && count >= 2) ? 2 : 1;
+    
+    int bestMask = -1;
+    float bestValue = 0;
+    
+    for (int mask = 1; mask < (1 << count); mask++) {
+        int kept = __builtin_popcount(mask);
+        if (kept < minKeep) continue;
+        
+        float value = planValue(state, &plans[mask], horizon);
+        if (bestMask < 0 || value > bestValue) {
+            bestValue = value;
+            bestMask = mask;
+        }
+    }
+    
+    if (bestMask < 0) {
+        return 0;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        chooseObjectives[i] = (bestMask & (1 << i)) ? 1 : 0;
+    }
+    
+    return 1;
+}
+
+// Multi-source Dijkstra from our network, plus wagons held tickets still need
+static void refreshDrawModel(GameState* state) {
+    int visited[MAX_CITIES];
+    int hasNetwork = 0;
+    
+    for (int i = 0; i < state->nbCities; i++) {
+        state->networkReach[i] = INF_DIST;
+        visited[i] = 0;
+    }
+    
+    for (int i = 0; i < state->nbClaimedRoutes; i++) {
+        int r = state->claimedRoutes[i];
+        if (r >= 0 && r < state->nbTracks) {
+            state->networkReach[state->routes[r].from] = 0;
+            state->networkReach[state->routes[r].to] = 0;
+            hasNetwork = 1;
+        }
+    }
+    
+    if (hasNetwork) {
+        for (int count = 0; count < state->nbCities; count++) {
+            int u = -1;
+            int minDist = INF_DIST;
+            
+            for (int i = 0; i < state->nbCities; i++) {
+                if (!visited[i] && state->networkReach[i] < minDist) {
+                    minDist = state->networkReach[i];
+                    u = i;
+                }
+            }
+            
+            if (u == -1) break;
+            visited[u] = 1;
+            
+            for (int i = 0; i < state->nbTracks; i++) {
+                if (state->routes[i].owner == 2) continue;
+                
+                int from = state->routes[i].from;
+                int to = state->routes[i].to;
+                if (from != u && to != u) continue;
+                
+                int v = (from == u) ? to : from;
+                int length = (state->routes[i].owner == 1) ? 0 : state->routes[i].length;
+                
+                if (state->networkReach[u] + length < state->networkReach[v]) {
+                    state->networkReach[v] = state->networkReach[u] + length;
+                }
+            }
+        }
+    }
+    
+    // Cumulative histogram of pair costs, so the draw estimate is a lookup
+    memset(state->pairsWithinReach, 0, sizeof(state->pairsWithinReach));
+    for (int a = 0; a < state->nbCities; a++) {
+        for (int b = a + 1; b < state->nbCities; b++) {
+            int cost = state->networkReach[a] + state->networkReach[b];
+            if (cost < 64) {
+                state->pairsWithinReach[cost]++;
+            }
+        }
+    }
+    for (int n = 1; n < 64; n++) {
+        state->pairsWithinReach[n] += state->pairsWithinReach[n - 1];
+    }
+    
+    PortfolioPlan held;
+    memset(&held, 0, sizeof(held));
+    for (int i = 0; i < state->nbObjectives; i++) {
+        if (isObjectiveOpen(state, state->objectives[i])) {
+            extendPlan(state, &held, state->objectives[i].from, state->objectives[i].to);
+        }
+    }
+    state->committedWagons = held.wagons;
+    
+    state->drawValueVersion = state->ownershipVersion;
+    state->drawValueObjectives = state->nbObjectives;
+}
+
+float estimateObjectiveDrawValue(GameState* state) {
+    if (!state || state->nbCities <= 1 || state->nbObjectives + MAX_CANDIDATES > MAX_OBJECTIVES) {
+        return -1;
+    }
+    
+    // Only recomputed when a route changes hands or tickets are added
+    if (state->drawValueVersion != state->ownershipVersion ||
+        state->drawValueObjectives != state->nbObjectives) {
+        refreshDrawModel(state);
+    }
+    
+    int turnsLeft = estimateTurnsLeft(state);
+    int wagonBudget = (turnsLeft < state->wagonsLeft) ? turnsLeft : state->wagonsLeft;
+    
+    // Half of what held tickets leave spare: detours and card luck eat the rest
+    int spareBudget = (wagonBudget - state->committedWagons * 2) / 2;
+    if (spareBudget <= 0) {
+        return -1;
+    }
+    
+    float averageScore = 0;
+    for (int i = 0; i < state->nbObjectives; i++) {
+        averageScore += state->objectives[i].score;
+    }
+    averageScore = (state->nbObjectives > 0) ? averageScore / state->nbObjectives : 10;
+    
+    // Share of city pairs our network could link within the budget
+    int pairs = state->nbCities * (state->nbCities - 1) / 2;
+    int reachable = state->pairsWithinReach[(spareBudget < 64) ? spareBudget : 63];
+    
+    float f = (float)reachable / pairs;
+    float miss = (1 - f) * (1 - f) * (1 - f);
+    float anyFeasible = 1 - miss;
+    
+    // We must keep at least one ticket: if none fits we eat the smallest one
+    float gain = anyFeasible * averageScore * 0.8f - miss * averageScore * 0.6f;
+    float tempoCost = 2.0f + averageScore * 2.0f / (turnsLeft > 1 ? turnsLeft : 1);
+    
+    return gain - tempoCost;
+}
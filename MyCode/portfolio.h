@@ -0,0 +1,13 @@
+#ifndef PORTFOLIO_H
+#define PORTFOLIO_H
+#include "gamestate.h"
+#include "../tickettorideapi/ticketToRide.h"
+
+#define MAX_CANDIDATES 3
+
+int estimateTurnsLeft(GameState* state);
+float evaluatePortfolio(GameState* state, Objective* candidates, int count, int keepMask);
+int choosePortfolio(GameState* state, Objective* candidates, int count, unsigned char* chooseObjectives);
+float estimateObjectiveDrawValue(GameState* state);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,231 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "protocol.h"
+#include "gamestate.h"
+
+void initProtoBuffer(ProtoBuffer* buffer) {
+    buffer->data = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+}
+
+void freeProtoBuffer(ProtoBuffer* buffer) {
+    free(buffer->data);
+    initProtoBuffer(buffer);
+}
+
+int protoAppend(ProtoBuffer* buffer, const void* data, int length) {
+    if (buffer->length + length > buffer->capacity) {
+        int capacity = buffer->capacity ? buffer->capacity : 256;
+        while (capacity < buffer->length + length) {
+            capacity *= 2;
+        }
+        
+        char* grown = realloc(buffer->data, capacity);
+        if (!grown) {
+            return 0;
+        }
+        buffer->data = grown;
+        buffer->capacity = capacity;
+    }
+    
+    memcpy(buffer->data + buffer->length, data, length);
+    buffer->length += length;
+    return 1;
+}
+
+void protoConsume(ProtoBuffer* buffer, int length) {
+    if (length >= buffer->length) {
+        buffer->length = 0;
+        return;
+    }
+    
+    memmove(buffer->data, buffer->data + length, buffer->length - length);
+    buffer->length -= length;
+}
+
+int writeFrame(ProtoBuffer* out, const char* command, const int* values, int count, const char* payload, int payloadLength) {
+    char number[24];
+    int ok = protoAppend(out, command, strlen(command));
+    
+    for (int i = 0; ok && i < count; i++) {
+        int n = snprintf(number, sizeof(number), " %d", values[i]);
+        ok = protoAppend(out, number, n);
+    }
+    
+    if (ok && payload) {
+        int n = snprintf(number, sizeof(number), " #%d", payloadLength);
+        ok = protoAppend(out, number, n);
+    }
+    
+    ok = ok && protoAppend(out, "\n", 1);
+    
+    if (ok && payload && payloadLength > 0) {
+        ok = protoAppend(out, payload, payloadLength);
+    }
+    return ok;
+}
+
+// 1 with a complete frame, 0 if more bytes are needed, -1 on a malformed stream
+int readFrame(ProtoBuffer* in, ProtoFrame* frame) {
+    const char* end = in->length > 0 ? memchr(in->data, '\n', in->length) : NULL;
+    if (!end) {
+        return in->length > PROTOCOL_MAX_FRAME ? -1 : 0;
+    }
+    
+    int headerLength = end - in->data + 1;
+    int commandLength = 0;
+    while (commandLength < headerLength - 1 && in->data[commandLength] != ' ') {
+        commandLength++;
+    }
+    if (commandLength == 0 || commandLength >= PROTOCOL_COMMAND_MAX) {
+        return -1;
+    }
+    
+    memcpy(frame->command, in->data, commandLength);
+    frame->command[commandLength] = '\0';
+    frame->args = in->data + commandLength;
+    frame->payloadLength = 0;
+    
+    // Payload marker is the last token of the line
+    const char* marker = end;
+    while (marker > frame->args && marker[-1] != ' ') {
+        marker--;
+    }
+    if (*marker == '#') {
+        frame->payloadLength = atoi(marker + 1);
+        if (frame->payloadLength < 0 || frame->payloadLength > PROTOCOL_MAX_FRAME) {
+            return -1;
+        }
+    }
+    
+    if (in->length < headerLength + frame->payloadLength) {
+        return 0;
+    }
+    
+    frame->payload = in->data + headerLength;
+    frame->frameLength = headerLength + frame->payloadLength;
+    return 1;
+}
+
+// Integers of a frame header, stopping at the payload marker or end of line
+int parseInts(const char* text, int* values, int max) {
+    int count = 0;
+    
+    while (count < max) {
+        while (*text == ' ') text++;
+        if (*text == '\n' || *text == '#' || *text == '\0') {
+            break;
+        }
+        
+        char* next;
+        long value = strtol(text, &next, 10);
+        if (next == text) {
+            break;
+        }
+        values[count++] = (int)value;
+        text = next;
+    }
+    return count;
+}
+
+void moveToArgs(const MoveData* move, int* args) {
+    memset(args, 0, sizeof(int) * 4);
+    
+    switch (move->action) {
+        case CLAIM_ROUTE:
+            args[0] = move->claimRoute.from;
+            args[1] = move->claimRoute.to;
+            args[2] = move->claimRoute.color;
+            args[3] = move->claimRoute.nbLocomotives;
+            break;
+        case DRAW_CARD:
+            args[0] = move->drawCard;
+            break;
+        case CHOOSE_OBJECTIVES:
+            for (int i = 0; i < 3; i++) {
+                args[i] = move->chooseObjectives[i];
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void moveFromArgs(int action, const int* args, MoveData* move) {
+    memset(move, 0, sizeof(MoveData));
+    move->action = action;
+    
+    switch (move->action) {
+        case CLAIM_ROUTE:
+            move->claimRoute.from = args[0];
+            move->claimRoute.to = args[1];
+            move->claimRoute.color = args[2];
+            move->claimRoute.nbLocomotives = args[3];
+            break;
+        case DRAW_CARD:
+            move->drawCard = args[0];
+            break;
+        case CHOOSE_OBJECTIVES:
+            for (int i = 0; i < 3; i++) {
+                move->chooseObjectives[i] = args[i] != 0;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// GAME frame of WAIT_GAME; gameName and trackData are allocated for the caller
+int parseGameFrame(const ProtoFrame* frame, GameData* gameData) {
+    int maxValues = 8 + MAX_ROUTES * 5;
+    int* values = malloc(sizeof(int) * maxValues);
+    int* trackData = malloc(sizeof(int) * MAX_ROUTES * 5);
+    char* gameName = malloc(frame->payloadLength + 1);
+    if (!values || !trackData || !gameName) {
+        free(values);
+        free(trackData);
+        free(gameName);
+        return 0;
+    }
+    
+    int count = parseInts(frame->args, values, maxValues);
+    int nbTracks = count >= 4 ? values[3] : -1;
+    if (count < 8 || values[2] <= 0 || values[2] > MAX_CITIES || nbTracks <= 0 ||
+        nbTracks > MAX_ROUTES || count != 8 + nbTracks * 5) {
+        free(values);
+        free(trackData);
+        free(gameName);
+        return 0;
+    }
+    
+    memcpy(gameName, frame->payload, frame->payloadLength);
+    gameName[frame->payloadLength] = '\0';
+    memcpy(trackData, values + 8, sizeof(int) * nbTracks * 5);
+    
+    gameData->gameName = gameName;
+    gameData->gameSeed = values[0];
+    gameData->starter = values[1];
+    gameData->nbCities = values[2];
+    gameData->nbTracks = nbTracks;
+    gameData->trackData = trackData;
+    for (int i = 0; i < 4; i++) {
+        gameData->cards[i] = values[4 + i];
+    }
+    
+    free(values);
+    return 1;
+}
+
+// RESULT values after the code: state replay card objectives(9); messages are left alone
+void resultFromArgs(const int* args, MoveResult* result) {
+    result->state = args[0];
+    result->replay = args[1] != 0;
+    result->card = args[2];
+    for (int i = 0; i < 3; i++) {
+        result->objectives[i].from = args[3 + i * 3];
+        result->objectives[i].to = args[4 + i * 3];
+        result->objectives[i].score = args[5 + i * 3];
+    }
+}
\ No newline at end of file
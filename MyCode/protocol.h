@@ -0,0 +1,48 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+#include "../tickettorideapi/ticketToRide.h"
+
+// Line protocol of t2rserver, spoken by the -l sessions and by the client API of
+// localapi.c; our own format, the remote server does not speak it.
+// A frame is "COMMAND int int ... [#n]\n" followed by n raw payload bytes:
+//   CONNECT #n name                 -> OK
+//   WAIT_GAME #n settings           -> GAME seed starter nbCities nbTracks c0..c3 tracks... #n gameName
+//   GET_MOVE                        -> MOVE code state replay action a b c d [c0..c4] #n message
+//   PLAY_MOVE action a b c d        -> RESULT code state replay card objectives(9) [c0..c4] #n message
+//   GET_BOARD                       -> BOARD code c0..c4
+//   QUIT                            -> BYE
+// Move arguments: claim from to color locomotives, draw color, choose keep0 keep1 keep2.
+// The optional [c0..c4] is the face-up row after the move; without it the client asks GET_BOARD.
+
+#define PROTOCOL_COMMAND_MAX 16
+#define PROTOCOL_MAX_FRAME (1 << 20)
+
+typedef struct {
+    char* data;
+    int length;
+    int capacity;
+} ProtoBuffer;
+
+typedef struct {
+    char command[PROTOCOL_COMMAND_MAX];
+    const char* args;      // integers after the command, up to the payload marker
+    const char* payload;   // not NUL-terminated
+    int payloadLength;
+    int frameLength;       // bytes to consume once handled
+} ProtoFrame;
+
+void initProtoBuffer(ProtoBuffer* buffer);
+void freeProtoBuffer(ProtoBuffer* buffer);
+int protoAppend(ProtoBuffer* buffer, const void* data, int length);
+void protoConsume(ProtoBuffer* buffer, int length);
+
+int writeFrame(ProtoBuffer* out, const char* command, const int* values, int count, const char* payload, int payloadLength);
+int readFrame(ProtoBuffer* in, ProtoFrame* frame);
+int parseInts(const char* text, int* values, int max);
+
+void moveToArgs(const MoveData* move, int* args);
+void moveFromArgs(int action, const int* args, MoveData* move);
+int parseGameFrame(const ProtoFrame* frame, GameData* gameData);
+void resultFromArgs(const int* args, MoveResult* result);
+
+#endif
\ No newline at end of file
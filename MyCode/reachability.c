@@ -0,0 +1,88 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "reachability.h"
+#include "rules.h"
+
+// Labels every city reachable from start without opponent routes
+static int labelFrom(GameState* state, int start, int label, int stopAt) {
+    int queue[MAX_CITIES];
+    int head = 0, tail = 0;
+    int seen[MAX_CITIES] = {0};
+    
+    queue[tail++] = start;
+    seen[start] = 1;
+    
+    while (head < tail) {
+        int u = queue[head++];
+        if (u == stopAt) {
+            return 1;
+        }
+        
+        for (int i = 0; i < state->nbTracks; i++) {
+            if (state->routes[i].owner == 2) continue;
+            
+            int from = state->routes[i].from;
+            int to = state->routes[i].to;
+            if (from != u && to != u) continue;
+            
+            int v = (from == u) ? to : from;
+            if (!seen[v]) {
+                seen[v] = 1;
+                queue[tail++] = v;
+            }
+        }
+    }
+    
+    if (label >= 0) {
+        for (int i = 0; i < tail; i++) {
+            state->cityComponent[queue[i]] = label;
+        }
+    }
+    
+    return 0;
+}
+
+void initReachability(GameState* state) {
+    if (!state) {
+        return;
+    }
+    
+    for (int i = 0; i < MAX_CITIES; i++) {
+        state->cityComponent[i] = -1;
+    }
+    state->nextComponentId = 0;
+    
+    for (int c = 0; c < state->nbCities; c++) {
+        if (state->cityComponent[c] < 0) {
+            labelFrom(state, c, state->nextComponentId++, -1);
+        }
+    }
+}
+
+void reachabilityRouteLost(GameState* state, int routeIndex) {
+    if (!state || routeIndex < 0 || routeIndex >= state->nbTracks) {
+        return;
+    }
+    
+    int from = state->routes[routeIndex].from;
+    int to = state->routes[routeIndex].to;
+    
+    if (state->cityComponent[from] != state->cityComponent[to]) {
+        return;
+    }
+    
+    // Still connected through a double route or another way round
+    if (labelFrom(state, from, -1, to)) {
+        return;
+    }
+    
+    labelFrom(state, from, state->nextComponentId++, -1);
+}
+
+int isObjectiveReachable(GameState* state, Objective objective) {
+    return state->cityComponent[objective.from] == state->cityComponent[objective.to];
+}
+
+int isObjectiveOpen(GameState* state, Objective objective) {
+    return !isObjectiveCompleted(state, objective) && isObjectiveReachable(state, objective);
+}
\ No newline at end of file
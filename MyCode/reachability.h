@@ -0,0 +1,11 @@
+#ifndef REACHABILITY_H
+#define REACHABILITY_H
+#include "gamestate.h"
+#include "../tickettorideapi/ticketToRide.h"
+
+void initReachability(GameState* state);
+void reachabilityRouteLost(GameState* state, int routeIndex);
+int isObjectiveReachable(GameState* state, Objective objective);
+int isObjectiveOpen(GameState* state, Objective objective);
+
+#endif
\ No newline at end of file
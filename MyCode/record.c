@@ -0,0 +1,497 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include "record.h"
+#include "protocol.h"
+
+#define TRACE_MAX_PAYLOAD (1 << 20)
+#define TRACE_NO_STRING 0xFFFFFFFFu
+#define TRACE_FILE_BUFFER (1 << 16)
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+} TraceHeader;
+
+// One API call, followed by its request and answer payloads (int32 fields, length-prefixed strings)
+typedef struct {
+    uint8_t kind;
+    uint8_t reserved[3];
+    int32_t code;
+    uint32_t requestLength;
+    uint32_t answerLength;
+    uint64_t timestampUs;   // call start, from the start of the trace
+    uint32_t elapsedUs;     // spent waiting for the server
+    uint32_t padding;
+} TraceRecord;
+
+typedef struct {
+    const char* data;
+    int length;
+    int offset;
+    int ok;
+} TraceReader;
+
+typedef enum {
+    MODE_LIVE,
+    MODE_RECORD,
+    MODE_REPLAY
+} TraceMode;
+
+// The client API is process-wide, so is its trace
+static TraceMode mode = MODE_LIVE;
+static FILE* traceFile = NULL;
+static uint64_t traceStart = 0;
+static ProtoBuffer request;
+static ProtoBuffer answer;
+static TraceReader reader;
+static char* replayData = NULL;   // request then answer of the call being replayed
+static int replayCapacity = 0;
+static long callCount = 0;
+static uint64_t recordedWaitUs = 0;
+static int exhausted = 0;
+
+static uint64_t nowUs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+static void putInts(ProtoBuffer* buffer, const int* values, int count) {
+    for (int i = 0; i < count; i++) {
+        int32_t value = values[i];
+        protoAppend(buffer, &value, sizeof(value));
+    }
+}
+
+static void putString(ProtoBuffer* buffer, const char* text) {
+    uint32_t length = text ? strlen(text) : TRACE_NO_STRING;
+    protoAppend(buffer, &length, sizeof(length));
+    if (text) {
+        protoAppend(buffer, text, length);
+    }
+}
+
+static void encodeMove(ProtoBuffer* buffer, const MoveData* moveData) {
+    int values[5];
+    values[0] = moveData->action;
+    moveToArgs(moveData, values + 1);
+    putInts(buffer, values, 5);
+}
+
+static void encodeMoveResult(ProtoBuffer* buffer, const MoveResult* moveResult) {
+    int values[12];
+    values[0] = moveResult->state;
+    values[1] = moveResult->replay;
+    values[2] = moveResult->card;
+    for (int i = 0; i < 3; i++) {
+        values[3 + i * 3] = moveResult->objectives[i].from;
+        values[4 + i * 3] = moveResult->objectives[i].to;
+        values[5 + i * 3] = moveResult->objectives[i].score;
+    }
+    putInts(buffer, values, 12);
+    putString(buffer, moveResult->opponentMessage);
+    putString(buffer, moveResult->message);
+}
+
+static void getInts(TraceReader* in, int* values, int count) {
+    if (!in->ok || in->offset + count * (int)sizeof(int32_t) > in->length) {
+        in->ok = 0;
+        memset(values, 0, sizeof(int) * count);
+        return;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        int32_t value;
+        memcpy(&value, in->data + in->offset, sizeof(value));
+        in->offset += sizeof(value);
+        values[i] = value;
+    }
+}
+
+// Heap copy like the client API hands out, NULL when none was recorded
+static char* getString(TraceReader* in) {
+    uint32_t length;
+    if (!in->ok || in->offset + (int)sizeof(length) > in->length) {
+        in->ok = 0;
+        return NULL;
+    }
+    
+    memcpy(&length, in->data + in->offset, sizeof(length));
+    in->offset += sizeof(length);
+    if (length == TRACE_NO_STRING) {
+        return NULL;
+    }
+    if (length > (uint32_t)(in->length - in->offset)) {
+        in->ok = 0;
+        return NULL;
+    }
+    
+    char* text = malloc(length + 1);
+    if (text) {
+        memcpy(text, in->data + in->offset, length);
+        text[length] = '\0';
+    }
+    in->offset += length;
+    return text;
+}
+
+static void decodeMove(TraceReader* in, MoveData* moveData) {
+    int values[5];
+    getInts(in, values, 5);
+    moveFromArgs(values[0], values + 1, moveData);
+}
+
+static void decodeMoveResult(TraceReader* in, MoveResult* moveResult) {
+    int values[12];
+    getInts(in, values, 12);
+    
+    memset(moveResult, 0, sizeof(MoveResult));
+    moveResult->state = values[0];
+    moveResult->replay = values[1] != 0;
+    moveResult->card = values[2];
+    for (int i = 0; i < 3; i++) {
+        moveResult->objectives[i].from = values[3 + i * 3];
+        moveResult->objectives[i].to = values[4 + i * 3];
+        moveResult->objectives[i].score = values[5 + i * 3];
+    }
+    moveResult->opponentMessage = getString(in);
+    moveResult->message = getString(in);
+}
+
+int startRecording(const char* path) {
+    traceFile = fopen(path, "wb");
+    if (!traceFile) {
+        printf("Cannot create trace %s\n", path);
+        return 0;
+    }
+    setvbuf(traceFile, NULL, _IOFBF, TRACE_FILE_BUFFER);
+    
+    TraceHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    header.version = TRACE_VERSION;
+    if (fwrite(&header, sizeof(header), 1, traceFile) != 1 || fflush(traceFile) != 0) {
+        printf("Cannot write trace %s\n", path);
+        fclose(traceFile);
+        traceFile = NULL;
+        return 0;
+    }
+    
+    initProtoBuffer(&request);
+    initProtoBuffer(&answer);
+    traceStart = nowUs();
+    callCount = 0;
+    mode = MODE_RECORD;
+    return 1;
+}
+
+int startReplay(const char* path) {
+    traceFile = fopen(path, "rb");
+    if (!traceFile) {
+        printf("Cannot open trace %s\n", path);
+        return 0;
+    }
+    
+    TraceHeader header;
+    if (fread(&header, sizeof(header), 1, traceFile) != 1 ||
+        memcmp(header.magic, TRACE_MAGIC, sizeof(header.magic)) != 0 || header.version != TRACE_VERSION) {
+        printf("%s is not a version %d trace\n", path, TRACE_VERSION);
+        fclose(traceFile);
+        traceFile = NULL;
+        return 0;
+    }
+    
+    initProtoBuffer(&request);
+    initProtoBuffer(&answer);
+    traceStart = nowUs();
+    callCount = 0;
+    recordedWaitUs = 0;
+    exhausted = 0;
+    mode = MODE_REPLAY;
+    return 1;
+}
+
+void stopTrace(void) {
+    if (mode == MODE_LIVE) {
+        return;
+    }
+    
+    double seconds = (nowUs() - traceStart) / 1e6;
+    if (mode == MODE_RECORD) {
+        printf("Trace: %ld calls recorded in %.2fs\n", callCount, seconds);
+    } else {
+        printf("Trace: %ld calls replayed in %.2fs (%.2fs waiting on the server when recorded)\n",
+               callCount, seconds, recordedWaitUs / 1e6);
+    }
+    
+    fclose(traceFile);
+    traceFile = NULL;
+    freeProtoBuffer(&request);
+    freeProtoBuffer(&answer);
+    free(replayData);
+    replayData = NULL;
+    replayCapacity = 0;
+    mode = MODE_LIVE;
+}
+
+int isReplaying(void) {
+    return mode == MODE_REPLAY;
+}
+
+int replayFinished(void) {
+    return mode == MODE_REPLAY && exhausted;
+}
+
+static void writeRecord(TraceKind kind, ResultCode code, uint64_t startUs) {
+    uint64_t endUs = nowUs();
+    TraceRecord record;
+    memset(&record, 0, sizeof(record));
+    record.kind = kind;
+    record.code = code;
+    record.requestLength = request.length;
+    record.answerLength = answer.length;
+    record.timestampUs = startUs - traceStart;
+    record.elapsedUs = endUs - startUs;
+    
+    // Flushed per call: a crash or Ctrl-C keeps every call made so far, the buffer
+    // only joins the record and its payloads in one write
+    if (fwrite(&record, sizeof(record), 1, traceFile) != 1 ||
+        (request.length > 0 && fwrite(request.data, 1, request.length, traceFile) != (size_t)request.length) ||
+        (answer.length > 0 && fwrite(answer.data, 1, answer.length, traceFile) != (size_t)answer.length) ||
+        fflush(traceFile) != 0) {
+        printf("Trace: write failed at call %ld, recording stopped\n", callCount);
+        stopTrace();
+        return;
+    }
+    callCount++;
+}
+
+// Next recorded call, checked against the one the bot makes now; 0 on divergence or end of trace
+static int replayCall(TraceKind kind, int checkRequest, ResultCode* code) {
+    TraceRecord record;
+    if (exhausted || fread(&record, sizeof(record), 1, traceFile) != 1) {
+        exhausted = 1;
+        return 0;
+    }
+    
+    if (record.requestLength > TRACE_MAX_PAYLOAD || record.answerLength > TRACE_MAX_PAYLOAD) {
+        printf("Replay: corrupt trace at call %ld\n", callCount);
+        exhausted = 1;
+        return 0;
+    }
+    
+    int recordedLength = record.requestLength;
+    int totalLength = recordedLength + record.answerLength;
+    if (totalLength > replayCapacity) {
+        char* grown = realloc(replayData, totalLength);
+        if (!grown) {
+            exhausted = 1;
+            return 0;
+        }
+        replayData = grown;
+        replayCapacity = totalLength;
+    }
+    
+    if (fread(replayData, 1, totalLength, traceFile) != (size_t)totalLength) {
+        exhausted = 1;
+        return 0;
+    }
+    
+    if (record.kind != kind ||
+        (checkRequest && (recordedLength != request.length || memcmp(replayData, request.data, recordedLength) != 0))) {
+        printf("Replay diverged at call %ld (recorded kind %d, now %d)\n", callCount, record.kind, kind);
+        exhausted = 1;
+        return 0;
+    }
+    
+    reader.data = replayData + recordedLength;
+    reader.length = record.answerLength;
+    reader.offset = 0;
+    reader.ok = 1;
+    *code = record.code;
+    recordedWaitUs += record.elapsedUs;
+    callCount++;
+    return 1;
+}
+
+ResultCode tracedConnect(const char* host, unsigned int port, const char* name) {
+    request.length = 0;
+    answer.length = 0;
+    ResultCode code = ALL_GOOD;
+    
+    if (mode == MODE_REPLAY) {
+        return replayCall(TRACE_CONNECT, 0, &code) ? code : SERVER_ERROR;
+    }
+    
+    uint64_t startUs = nowUs();
+    code = connectToCGS(host, port, name);
+    if (mode == MODE_RECORD) {
+        int values[1] = {(int)port};
+        putInts(&request, values, 1);
+        putString(&request, host);
+        putString(&request, name);
+        writeRecord(TRACE_CONNECT, code, startUs);
+    }
+    return code;
+}
+
+ResultCode tracedGameSettings(const char* settings, GameData* gameData) {
+    request.length = 0;
+    answer.length = 0;
+    putString(&request, settings);
+    ResultCode code = ALL_GOOD;
+    
+    if (mode == MODE_REPLAY) {
+        memset(gameData, 0, sizeof(GameData));
+        if (!replayCall(TRACE_SETTINGS, 1, &code)) {
+            return SERVER_ERROR;
+        }
+        if (code != ALL_GOOD) {
+            return code;
+        }
+        
+        int values[8];
+        getInts(&reader, values, 8);
+        gameData->gameSeed = values[0];
+        gameData->starter = values[1];
+        gameData->nbCities = values[2];
+        gameData->nbTracks = values[3];
+        for (int i = 0; i < 4; i++) {
+            gameData->cards[i] = values[4 + i];
+        }
+        
+        if (gameData->nbTracks < 0 || gameData->nbTracks > TRACE_MAX_PAYLOAD / 20) {
+            return SERVER_ERROR;
+        }
+        gameData->trackData = malloc(sizeof(int) * 5 * (gameData->nbTracks + 1));
+        if (!gameData->trackData) {
+            return SERVER_ERROR;
+        }
+        getInts(&reader, gameData->trackData, gameData->nbTracks * 5);
+        gameData->gameName = getString(&reader);
+        if (!reader.ok) {
+            free(gameData->trackData);
+            free(gameData->gameName);
+            gameData->trackData = NULL;
+            gameData->gameName = NULL;
+            return SERVER_ERROR;
+        }
+        return code;
+    }
+    
+    uint64_t startUs = nowUs();
+    code = sendGameSettings(settings, gameData);
+    // A refused game carries no game data, only the code is recorded
+    if (mode == MODE_RECORD && code == ALL_GOOD) {
+        int values[8] = {gameData->gameSeed, gameData->starter, gameData->nbCities, gameData->nbTracks};
+        for (int i = 0; i < 4; i++) {
+            values[4 + i] = gameData->cards[i];
+        }
+        putInts(&answer, values, 8);
+        if (gameData->trackData) {
+            putInts(&answer, gameData->trackData, gameData->nbTracks * 5);
+        }
+        putString(&answer, gameData->gameName);
+        writeRecord(TRACE_SETTINGS, code, startUs);
+    } else if (mode == MODE_RECORD) {
+        writeRecord(TRACE_SETTINGS, code, startUs);
+    }
+    return code;
+}
+
+ResultCode tracedGetMove(MoveData* moveData, MoveResult* moveResult) {
+    request.length = 0;
+    answer.length = 0;
+    ResultCode code = ALL_GOOD;
+    
+    if (mode == MODE_REPLAY) {
+        if (!replayCall(TRACE_GET_MOVE, 0, &code)) {
+            return SERVER_ERROR;
+        }
+        decodeMove(&reader, moveData);
+        decodeMoveResult(&reader, moveResult);
+        return reader.ok ? code : SERVER_ERROR;
+    }
+    
+    uint64_t startUs = nowUs();
+    code = getMove(moveData, moveResult);
+    if (mode == MODE_RECORD) {
+        encodeMove(&answer, moveData);
+        encodeMoveResult(&answer, moveResult);
+        writeRecord(TRACE_GET_MOVE, code, startUs);
+    }
+    return code;
+}
+
+ResultCode tracedSendMove(const MoveData* moveData, MoveResult* moveResult) {
+    request.length = 0;
+    answer.length = 0;
+    encodeMove(&request, moveData);
+    ResultCode code = ALL_GOOD;
+    
+    if (mode == MODE_REPLAY) {
+        if (!replayCall(TRACE_SEND_MOVE, 1, &code)) {
+            return SERVER_ERROR;
+        }
+        decodeMoveResult(&reader, moveResult);
+        return reader.ok ? code : SERVER_ERROR;
+    }
+    
+    uint64_t startUs = nowUs();
+    code = sendMove(moveData, moveResult);
+    if (mode == MODE_RECORD) {
+        encodeMoveResult(&answer, moveResult);
+        writeRecord(TRACE_SEND_MOVE, code, startUs);
+    }
+    return code;
+}
+
+ResultCode tracedGetBoardState(BoardState* boardState) {
+    request.length = 0;
+    answer.length = 0;
+    ResultCode code = ALL_GOOD;
+    int cards[5];
+    
+    if (mode == MODE_REPLAY) {
+        if (!replayCall(TRACE_BOARD, 0, &code)) {
+            return SERVER_ERROR;
+        }
+        getInts(&reader, cards, 5);
+        for (int i = 0; i < 5; i++) {
+            boardState->card[i] = cards[i];
+        }
+        return reader.ok ? code : SERVER_ERROR;
+    }
+    
+    uint64_t startUs = nowUs();
+    code = getBoardState(boardState);
+    if (mode == MODE_RECORD) {
+        for (int i = 0; i < 5; i++) {
+            cards[i] = boardState->card[i];
+        }
+        putInts(&answer, cards, 5);
+        writeRecord(TRACE_BOARD, code, startUs);
+    }
+    return code;
+}
+
+ResultCode tracedQuit(void) {
+    request.length = 0;
+    answer.length = 0;
+    ResultCode code = ALL_GOOD;
+    
+    if (mode == MODE_REPLAY) {
+        return replayCall(TRACE_QUIT, 0, &code) ? code : SERVER_ERROR;
+    }
+    
+    uint64_t startUs = nowUs();
+    code = quitGame();
+    if (mode == MODE_RECORD) {
+        writeRecord(TRACE_QUIT, code, startUs);
+    }
+    return code;
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#ifndef RECORD_H
+#define RECORD_H
+#include "../tickettorideapi/ticketToRide.h"
+
+// Recording and replay of the client API calls of the sequential mode.
+// Every call is stored with its request, its answer and timestamps; a replay
+// answers from the file without a network and stops at the first divergence.
+#define TRACE_MAGIC "T2RTRACE"
+#define TRACE_VERSION 1
+
+typedef enum {
+    TRACE_CONNECT = 1,
+    TRACE_SETTINGS,
+    TRACE_GET_MOVE,
+    TRACE_SEND_MOVE,
+    TRACE_BOARD,
+    TRACE_QUIT
+} TraceKind;
+
+int startRecording(const char* path);
+int startReplay(const char* path);
+void stopTrace(void);
+int isReplaying(void);
+int replayFinished(void);
+
+ResultCode tracedConnect(const char* host, unsigned int port, const char* name);
+ResultCode tracedGameSettings(const char* settings, GameData* gameData);
+ResultCode tracedGetMove(MoveData* moveData, MoveResult* moveResult);
+ResultCode tracedSendMove(const MoveData* moveData, MoveResult* moveResult);
+ResultCode tracedGetBoardState(BoardState* boardState);
+ResultCode tracedQuit(void);
+
+#endif
\ No newline at end of file
@@ -259,8 +259,41 @@ int findRouteIndex(GameState* state, int from, int to) {
     return -1;
 }
 
+static int linkRoot(GameState* state, int city) {
+    while (state->cityLink[city] != city) {
+        state->cityLink[city] = state->cityLink[state->cityLink[city]];
+        city = state->cityLink[city];
+    }
+    return city;
+}
+
+int citiesConnected(GameState* state, int a, int b) {
+    if (!state || a < 0 || a >= state->nbCities || b < 0 || b >= state->nbCities) {
+        return 0;
+    }
+    return linkRoot(state, a) == linkRoot(state, b);
+}
+
+// Our routes are never lost, so union-find is all connectivity ever needs
+void linkCities(GameState* state, int a, int b) {
+    if (!state || a < 0 || a >= state->nbCities || b < 0 || b >= state->nbCities) {
+        return;
+    }
+    state->cityLink[linkRoot(state, a)] = linkRoot(state, b);
+}
+
 int isObjectiveCompleted(GameState* state, Objective objective) {
-    return state->cityConnected[objective.from][objective.to];
+    return citiesConnected(state, objective.from, objective.to);
+}
+
+// Points for claiming a route; 0 for a length outside the rules
+int routePointsForLength(int length) {
+    static const int pointsByLength[] = {0, 1, 2, 4, 7, 10, 15};
+    
+    if (length < 0 || length > 6) {
+        return 0;
+    }
+    return pointsByLength[length];
 }
 
 int calculateScore(GameState* state) {
@@ -271,12 +304,7 @@ int calculateScore(GameState* state) {
         int routeIndex = state->claimedRoutes[i];
         
         if (routeIndex >= 0 && routeIndex < state->nbTracks) {
-            int length = state->routes[routeIndex].length;
-            
-            if (length >= 0 && length <= 6) {
-                int pointsByLength[] = {0, 1, 2, 4, 7, 10, 15};
-                score += pointsByLength[length];
-            }
+            score += routePointsForLength(state->routes[routeIndex].length);
         }
     }
     
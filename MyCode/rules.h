@@ -11,8 +11,11 @@ int isValidMove(GameState* state, MoveData* move);
 int isLastTurn(GameState* state);
 int routeOwner(GameState* state, int from, int to);
 int findRouteIndex(GameState* state, int from, int to);
+void linkCities(GameState* state, int a, int b);
+int citiesConnected(GameState* state, int a, int b);
 int isObjectiveCompleted(GameState* state, Objective objective);
 int completeObjectivesCount(GameState* state);
+int routePointsForLength(int length);
 int calculateScore(GameState* state);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "segments.h"
+
+#define SEGMENT_WORDS ((MAX_CITIES + 63) / 64)
+
+void initSegments(GameState* state) {
+    if (!state) {
+        return;
+    }
+    
+    state->segmentsVersion = -1;
+}
+
+static int findRoot(int* parent, int x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+// Our routes contracted: each owned component becomes one node
+static int contractOwned(GameState* state) {
+    int parent[MAX_CITIES];
+    for (int c = 0; c < state->nbCities; c++) {
+        parent[c] = c;
+    }
+    
+    for (int r = 0; r < state->nbTracks; r++) {
+        if (state->routes[r].owner != 1) continue;
+        int a = findRoot(parent, state->routes[r].from);
+        int b = findRoot(parent, state->routes[r].to);
+        if (a != b) parent[a] = b;
+    }
+    
+    int label[MAX_CITIES];
+    int nbComponents = 0;
+    for (int c = 0; c < state->nbCities; c++) {
+        label[c] = -1;
+    }
+    for (int c = 0; c < state->nbCities; c++) {
+        int root = findRoot(parent, c);
+        if (label[root] < 0) {
+            label[root] = nbComponents++;
+        }
+        state->ownedComponent[c] = label[root];
+    }
+    
+    return nbComponents;
+}
+
+// All-pairs BFS by free segments, every source advanced at once:
+// bit s of frontier[v] means source s reached v at the current depth.
+// 0 when out of memory: the table is left invalid, the components are still set
+static int computeSegments(GameState* state) {
+    int n = contractOwned(state);
+    state->segmentsVersion = -1;
+    
+    // Heap: MAX_CITIES may be raised for large maps
+    uint16_t (*dist)[MAX_CITIES] = malloc(sizeof(uint16_t[MAX_CITIES][MAX_CITIES]));
+    uint64_t (*visited)[SEGMENT_WORDS] = calloc(MAX_CITIES, sizeof(uint64_t[SEGMENT_WORDS]));
+    uint64_t (*frontier)[SEGMENT_WORDS] = calloc(MAX_CITIES, sizeof(uint64_t[SEGMENT_WORDS]));
+    uint64_t (*next)[SEGMENT_WORDS] = malloc(sizeof(uint64_t[MAX_CITIES][SEGMENT_WORDS]));
+    if (!dist || !visited || !frontier || !next) {
+        free(dist);
+        free(visited);
+        free(frontier);
+        free(next);
+        return 0;
+    }
+    
+    // All bytes 0xFF: every distance starts at SEGMENTS_UNREACHABLE
+    memset(dist, 0xFF, sizeof(uint16_t[MAX_CITIES][MAX_CITIES]));
+    
+    for (int v = 0; v < n; v++) {
+        visited[v][v / 64] |= 1ULL << (v % 64);
+        frontier[v][v / 64] |= 1ULL << (v % 64);
+        dist[v][v] = 0;
+    }
+    
+    for (int depth = 1; depth < SEGMENTS_UNREACHABLE; depth++) {
+        memset(next, 0, sizeof(uint64_t[MAX_CITIES][SEGMENT_WORDS]));
+        
+        for (int r = 0; r < state->nbTracks; r++) {
+            if (state->routes[r].owner != 0) continue;
+            int a = state->ownedComponent[state->routes[r].from];
+            int b = state->ownedComponent[state->routes[r].to];
+            if (a == b) continue;
+            
+            for (int w = 0; w < SEGMENT_WORDS; w++) {
+                next[a][w] |= frontier[b][w];
+                next[b][w] |= frontier[a][w];
+            }
+        }
+        
+        int progressed = 0;
+        for (int v = 0; v < n; v++) {
+            for (int w = 0; w < SEGMENT_WORDS; w++) {
+                uint64_t fresh = next[v][w] & ~visited[v][w];
+                frontier[v][w] = fresh;
+                visited[v][w] |= fresh;
+                
+                while (fresh) {
+                    int s = w * 64 + __builtin_ctzll(fresh);
+                    dist[s][v] = (uint16_t)depth;
+                    fresh &= fresh - 1;
+                    progressed = 1;
+                }
+            }
+        }
+        
+        if (!progressed) break;
+    }
+    
+    for (int a = 0; a < state->nbCities; a++) {
+        for (int b = 0; b < state->nbCities; b++) {
+            state->missingSegments[a][b] = dist[state->ownedComponent[a]][state->ownedComponent[b]];
+        }
+    }
+    
+    free(dist);
+    free(visited);
+    free(frontier);
+    free(next);
+    state->segmentsVersion = state->ownershipVersion;
+    return 1;
+}
+
+// Fewest routes still to claim to link two cities, SEGMENTS_UNREACHABLE if cut off
+int segmentsNeeded(GameState* state, int from, int to) {
+    if (!state || from < 0 || from >= state->nbCities || to < 0 || to >= state->nbCities) {
+        return SEGMENTS_UNREACHABLE;
+    }
+    
+    if (state->segmentsVersion != state->ownershipVersion && !computeSegments(state)) {
+        return SEGMENTS_UNREACHABLE;
+    }
+    
+    return state->missingSegments[from][to];
+}
+
+int ownedComponentOf(GameState* state, int city) {
+    if (!state || city < 0 || city >= state->nbCities) {
+        return -1;
+    }
+    
+    if (state->segmentsVersion != state->ownershipVersion) {
+        computeSegments(state);
+    }
+    
+    return state->ownedComponent[city];
+}
\ No newline at end of file
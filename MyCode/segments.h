@@ -0,0 +1,12 @@
+#ifndef SEGMENTS_H
+#define SEGMENTS_H
+#include "gamestate.h"
+#include "../tickettorideapi/ticketToRide.h"
+
+#define SEGMENTS_UNREACHABLE UINT16_MAX
+
+void initSegments(GameState* state);
+int segmentsNeeded(GameState* state, int from, int to);
+int ownedComponentOf(GameState* state, int city);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,442 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "gamestate.h"
+#include "strategy.h"
+#include "player.h"
+#include "engine.h"
+
+// Offline self-play: ./selfplay [-g games] [-t threads] [-o bot|greedy|random] [-m map file] [-s seed]
+// Our strategy always sits in seat 0, the starter alternates from game to game.
+
+#define DEFAULT_GAMES 1000
+#define DEFAULT_THREADS 4
+#define RANDOM_MAP_CITIES 36
+#define RANDOM_MAP_TRACKS 95
+#define RANDOM_MAP_TICKETS 40
+#define Z_95 1.96
+
+typedef enum {
+    OPPONENT_RANDOM,
+    OPPONENT_GREEDY,
+    OPPONENT_BOT
+} OpponentKind;
+
+typedef struct {
+    int gameIndex;
+    int score[ENGINE_PLAYERS];
+    int objectivesCompleted;
+    int objectives;
+    int wagonsLeft;
+    int longestPath;
+    int longestBonus;
+    int winner;         // seat, -1 on a tie
+    int turns;
+    int illegalMoves;   // our proposals the referee refused
+    int stalled;        // nobody could move any more
+} GameRecord;
+
+// One seat at the table: our strategy with its own view of the game, or a scripted player
+typedef struct {
+    OpponentKind kind;
+    GameContext* game;
+    Objective offered[3];
+    int nbOffered;
+} Seat;
+
+typedef struct {
+    int nbGames;
+    int nbThreads;
+    OpponentKind opponent;
+    const EngineMap* map;   // NULL: a fresh random map per game
+    uint64_t seed;
+} SelfPlayConfig;
+
+// Written by its thread only, read after the join
+typedef struct {
+    pthread_t thread;
+    const SelfPlayConfig* config;
+    atomic_int* nextGame;
+    GameRecord* records;
+    int nbRecords;
+    Engine engine;
+    EngineMap map;
+    GameContext contexts[ENGINE_PLAYERS];
+} Worker;
+
+static void seatStart(Seat* seat, const Engine* engine, int player) {
+    seat->nbOffered = 0;
+    if (!seat->game) {
+        return;
+    }
+    
+    GameData gameData;
+    mapGameData(engine->map, &gameData);
+    initGameState(&seat->game->state, &gameData);
+    initStrategyContext(&seat->game->strategy);
+    seat->game->cardDrawnThisTurn = 0;
+    
+    for (int i = 0; i < 4; i++) {
+        addCardToHand(&seat->game->state, engine->startCards[player][i]);
+    }
+}
+
+static void botMove(Seat* seat, const Engine* engine, MoveData* move) {
+    GameState* state = &seat->game->state;
+    memset(move, 0, sizeof(MoveData));
+    
+    for (int i = 0; i < 5; i++) {
+        state->visibleCards[i] = engine->faceUp[i];
+    }
+    
+    if (seat->nbOffered > 0) {
+        unsigned char choose[3] = {1, 1, 1};
+        chooseObjectivesStrategy(state, seat->offered, choose);
+        
+        move->action = CHOOSE_OBJECTIVES;
+        for (int i = 0; i < seat->nbOffered; i++) {
+            move->chooseObjectives[i] = choose[i] != 0;
+        }
+        if (!choose[0] && !choose[1] && !choose[2]) {
+            move->chooseObjectives[0] = true;
+        }
+    } else if (state->nbObjectives == 0 && state->nbClaimedRoutes == 0) {
+        move->action = DRAW_OBJECTIVES;
+    } else if (seat->game->cardDrawnThisTurn) {
+        chooseSecondCard(state, move);
+    } else if (state->wagonsLeft <= 1 || decideNextMove(state, &seat->game->strategy, move) != 1) {
+        move->action = DRAW_BLIND_CARD;
+    }
+}
+
+// Same bookkeeping as applyMoveResult, with the referee in place of the server
+static void botAfterOwnMove(Seat* seat, const MoveData* move, const MoveResult* result) {
+    GameState* state = &seat->game->state;
+    
+    switch (move->action) {
+        case CLAIM_ROUTE:
+            {
+                int routeLength = 0;
+                for (int i = 0; i < state->nbTracks; i++) {
+                    Route* route = &state->routes[i];
+                    if ((route->from == (int)move->claimRoute.from && route->to == (int)move->claimRoute.to) ||
+                        (route->from == (int)move->claimRoute.to && route->to == (int)move->claimRoute.from)) {
+                        routeLength = route->length;
+                        break;
+                    }
+                }
+                
+                addClaimedRoute(state, move->claimRoute.from, move->claimRoute.to);
+                removeCardsForRoute(state, move->claimRoute.color, routeLength, move->claimRoute.nbLocomotives);
+                if (state->wagonsLeft <= 2) {
+                    state->lastTurn = 1;
+                }
+            }
+            break;
+        
+        case DRAW_CARD:
+        case DRAW_BLIND_CARD:
+            addCardToHand(state, result->card);
+            seat->game->cardDrawnThisTurn = result->replay ? 1 : 0;
+            break;
+        
+        case CHOOSE_OBJECTIVES:
+            {
+                Objective kept[3];
+                int nbKept = 0;
+                for (int i = 0; i < seat->nbOffered; i++) {
+                    if (move->chooseObjectives[i]) {
+                        kept[nbKept++] = seat->offered[i];
+                    }
+                }
+                addObjectives(state, kept, nbKept);
+            }
+            break;
+        
+        default:
+            break;
+    }
+}
+
+static void seatAfterOwnMove(Seat* seat, const MoveData* move, const MoveResult* result, int offered) {
+    if (seat->game) {
+        botAfterOwnMove(seat, move, result);
+    }
+    
+    if (move->action == DRAW_OBJECTIVES) {
+        seat->nbOffered = offered;
+        memcpy(seat->offered, result->objectives, sizeof(seat->offered));
+    } else if (move->action == CHOOSE_OBJECTIVES) {
+        seat->nbOffered = 0;
+    }
+}
+
+static void seatAfterOpponentMove(Seat* seat, const MoveData* move) {
+    if (seat->game && move->action != DRAW_OBJECTIVES) {
+        MoveData seen = *move;
+        updateAfterOpponentMove(&seat->game->state, &seen);
+    }
+}
+
+// Fallbacks when the referee refuses a move, in the order the live client would try them
+static MoveState playWithFallback(Engine* engine, int player, MoveData* move, MoveResult* result) {
+    MoveState state = playEngineMove(engine, player, move, result);
+    if (state != ILLEGAL_MOVE || move->action == CHOOSE_OBJECTIVES) {
+        return state;
+    }
+    
+    memset(move, 0, sizeof(MoveData));
+    move->action = DRAW_BLIND_CARD;
+    state = playEngineMove(engine, player, move, result);
+    
+    for (int i = 0; i < 5 && state == ILLEGAL_MOVE; i++) {
+        if (engine->faceUp[i] != NONE) {
+            move->action = DRAW_CARD;
+            move->drawCard = engine->faceUp[i];
+            state = playEngineMove(engine, player, move, result);
+        }
+    }
+    return state;
+}
+
+static void playSelfGame(Worker* worker, int gameIndex, GameRecord* record) {
+    const SelfPlayConfig* config = worker->config;
+    Engine* engine = &worker->engine;
+    
+    // One stream per game, so results do not depend on which thread ran it
+    EngineRng rng;
+    seedRng(&rng, config->seed ^ ((uint64_t)gameIndex * 0xD1B54A32D192ED03ULL));
+    nextRandom(&rng);
+    
+    const EngineMap* map = config->map;
+    if (!map) {
+        generateEngineMap(&worker->map, &rng, RANDOM_MAP_CITIES, RANDOM_MAP_TRACKS, RANDOM_MAP_TICKETS);
+        map = &worker->map;
+    }
+    startEngineGame(engine, map, nextRandom(&rng), gameIndex % ENGINE_PLAYERS);
+    
+    Seat seats[ENGINE_PLAYERS] = {
+        {OPPONENT_BOT, &worker->contexts[0], {{0}}, 0},
+        {config->opponent, config->opponent == OPPONENT_BOT ? &worker->contexts[1] : NULL, {{0}}, 0}
+    };
+    for (int p = 0; p < ENGINE_PLAYERS; p++) {
+        seatStart(&seats[p], engine, p);
+    }
+    
+    memset(record, 0, sizeof(GameRecord));
+    record->gameIndex = gameIndex;
+    
+    while (!engine->over) {
+        int player = engine->current;
+        Seat* seat = &seats[player];
+        MoveData move;
+        MoveResult result;
+        
+        if (seat->game) {
+            botMove(seat, engine, &move);
+        } else {
+            scriptedMove(engine, player, seat->kind == OPPONENT_GREEDY ? SCRIPT_GREEDY : SCRIPT_RANDOM, &rng, &move);
+        }
+        
+        MoveData proposed = move;
+        MoveState state = playWithFallback(engine, player, &move, &result);
+        if (player == 0 && memcmp(&proposed, &move, sizeof(MoveData)) != 0) {
+            record->illegalMoves++;
+        }
+        if (state == ILLEGAL_MOVE) {
+            record->stalled = 1;
+            break;
+        }
+        
+        seatAfterOwnMove(seat, &move, &result, engine->nbOffered[player]);
+        seatAfterOpponentMove(&seats[1 - player], &move);
+    }
+    
+    EngineScore scores[ENGINE_PLAYERS];
+    scoreEngineGame(engine, scores);
+    
+    for (int p = 0; p < ENGINE_PLAYERS; p++) {
+        record->score[p] = scores[p].total;
+    }
+    record->objectivesCompleted = scores[0].objectivesCompleted;
+    record->objectives = engine->nbObjectives[0];
+    record->wagonsLeft = scores[0].wagonsLeft;
+    record->longestPath = scores[0].longestPath;
+    record->longestBonus = scores[0].longestBonus > 0;
+    record->turns = engine->turns;
+    record->winner = scores[0].total == scores[1].total ? -1 : (scores[0].total > scores[1].total ? 0 : 1);
+}
+
+static void* workerMain(void* arg) {
+    Worker* worker = arg;
+    
+    for (;;) {
+        int gameIndex = atomic_fetch_add(worker->nextGame, 1);
+        if (gameIndex >= worker->config->nbGames) {
+            break;
+        }
+        playSelfGame(worker, gameIndex, &worker->records[worker->nbRecords++]);
+    }
+    return NULL;
+}
+
+static double elapsedSeconds(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Wilson score interval, sane at win rates near 0 or 1
+static void wilsonInterval(int wins, int games, double* low, double* high) {
+    if (games == 0) {
+        *low = *high = 0;
+        return;
+    }
+    
+    double p = (double)wins / games;
+    double z2 = Z_95 * Z_95;
+    double center = (p + z2 / (2 * games)) / (1 + z2 / games);
+    double margin = Z_95 * sqrt(p * (1 - p) / games + z2 / (4.0 * games * games)) / (1 + z2 / games);
+    *low = center - margin;
+    *high = center + margin;
+}
+
+static void printReport(const Worker* workers, int nbThreads, double seconds) {
+    int games = 0, wins = 0, ties = 0, stalled = 0, illegal = 0, longestBonus = 0;
+    double score = 0, scoreSquares = 0, opponentScore = 0;
+    double objectives = 0, objectivesHeld = 0, wagons = 0, longestPath = 0, turns = 0;
+    
+    for (int t = 0; t < nbThreads; t++) {
+        for (int i = 0; i < workers[t].nbRecords; i++) {
+            const GameRecord* record = &workers[t].records[i];
+            games++;
+            wins += record->winner == 0;
+            ties += record->winner == -1;
+            stalled += record->stalled;
+            illegal += record->illegalMoves;
+            longestBonus += record->longestBonus;
+            score += record->score[0];
+            scoreSquares += (double)record->score[0] * record->score[0];
+            opponentScore += record->score[1];
+            objectives += record->objectivesCompleted;
+            objectivesHeld += record->objectives;
+            wagons += record->wagonsLeft;
+            longestPath += record->longestPath;
+            turns += record->turns;
+        }
+    }
+    
+    if (games == 0) {
+        printf("No games played\n");
+        return;
+    }
+    
+    double low, high;
+    wilsonInterval(wins, games, &low, &high);
+    double mean = score / games;
+    double deviation = games > 1 ? sqrt((scoreSquares - games * mean * mean) / (games - 1)) : 0;
+    
+    printf("\n=== SELF-PLAY ===\n");
+    printf("Games: %d (%d ties, %d stalled) on %d threads in %.2fs, %.1f games/s\n",
+           games, ties, stalled, nbThreads, seconds, games / seconds);
+    printf("Win rate: %.1f%% [%.1f%%, %.1f%%] (95%% CI)\n", 100.0 * wins / games, 100.0 * low, 100.0 * high);
+    printf("Score: %.1f +/- %.1f (opponent %.1f)\n", mean, Z_95 * deviation / sqrt(games), opponentScore / games);
+    printf("Objectives completed: %.2f of %.2f\n", objectives / games, objectivesHeld / games);
+    printf("Wagons left: %.1f, longest path %.1f (bonus in %.1f%% of games)\n",
+           wagons / games, longestPath / games, 100.0 * longestBonus / games);
+    printf("Turns: %.1f, refused moves: %.2f per game\n", turns / games, (double)illegal / games);
+}
+
+static int parseOpponent(const char* name, OpponentKind* kind) {
+    if (strcmp(name, "random") == 0) {
+        *kind = OPPONENT_RANDOM;
+    } else if (strcmp(name, "greedy") == 0) {
+        *kind = OPPONENT_GREEDY;
+    } else if (strcmp(name, "bot") == 0) {
+        *kind = OPPONENT_BOT;
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    static EngineMap fixedMap;
+    SelfPlayConfig config = {DEFAULT_GAMES, DEFAULT_THREADS, OPPONENT_GREEDY, NULL, 1};
+    int option;
+    
+    while ((option = getopt(argc, argv, "g:t:o:m:s:")) != -1) {
+        switch (option) {
+            case 'g':
+                config.nbGames = atoi(optarg);
+                break;
+            case 't':
+                config.nbThreads = atoi(optarg);
+                break;
+            case 'o':
+                if (!parseOpponent(optarg, &config.opponent)) {
+                    printf("Unknown opponent %s (bot, greedy or random)\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'm':
+                if (!loadEngineMap(&fixedMap, optarg)) {
+                    return 1;
+                }
+                config.map = &fixedMap;
+                break;
+            case 's':
+                config.seed = strtoull(optarg, NULL, 10);
+                break;
+            default:
+                printf("Usage: %s [-g games] [-t threads] [-o bot|greedy|random] [-m map file] [-s seed]\n", argv[0]);
+                return 1;
+        }
+    }
+    
+    if (config.nbGames < 1 || config.nbThreads < 1) {
+        printf("Need at least one game and one thread\n");
+        return 1;
+    }
+    if (config.nbThreads > config.nbGames) {
+        config.nbThreads = config.nbGames;
+    }
+    
+    Worker* workers = calloc(config.nbThreads, sizeof(Worker));
+    if (!workers) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    
+    atomic_int nextGame = 0;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    
+    int started = 0;
+    for (int t = 0; t < config.nbThreads; t++) {
+        workers[t].config = &config;
+        workers[t].nextGame = &nextGame;
+        workers[t].records = malloc(sizeof(GameRecord) * config.nbGames);
+        if (!workers[t].records || pthread_create(&workers[t].thread, NULL, workerMain, &workers[t]) != 0) {
+            break;
+        }
+        started++;
+    }
+    
+    for (int t = 0; t < started; t++) {
+        pthread_join(workers[t].thread, NULL);
+    }
+    
+    printReport(workers, started, elapsedSeconds(&start));
+    
+    for (int t = 0; t < config.nbThreads; t++) {
+        free(workers[t].records);
+    }
+    free(workers);
+    return started > 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,658 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include "engine.h"
+#include "protocol.h"
+
+// Local game server: ./t2rserver [-p port] [-l latency ms] [-j jitter ms]
+//                                [-o greedy|random] [-m map file] [-s seed] [-v]
+// Speaks the line protocol of protocol.h: the -l sessions talk it directly, everything else
+// through the client API of localapi.c (tickettoridebot-local). The client always sits in
+// engine seat 0.
+
+#define DEFAULT_PORT 15001
+#define SERVER_BACKLOG 1024
+#define SERVER_MAX_EVENTS 256
+#define SERVER_MAX_PENDING 32     // delayed replies queued per connection
+#define SERVER_MESSAGE_MAX 2048
+#define READ_CHUNK 4096
+#define RANDOM_MAP_CITIES 36
+#define RANDOM_MAP_TRACKS 95
+#define RANDOM_MAP_TICKETS 40
+
+typedef struct {
+    unsigned int port;
+    int latencyMs;
+    int jitterMs;
+    ScriptKind opponent;
+    const EngineMap* map;   // NULL: a fresh random map per game
+    uint64_t seed;
+    int verbose;
+} ServerConfig;
+
+typedef enum {
+    CLIENT_HELLO,      // waiting for CONNECT
+    CLIENT_LOBBY,      // connected, no game yet
+    CLIENT_PLAYING,
+    CLIENT_CLOSING     // BYE queued, close once flushed
+} ClientPhase;
+
+// Reply held back until readyAt to simulate the network
+typedef struct {
+    int length;
+    long long readyAt;
+} PendingReply;
+
+typedef struct Client {
+    int fd;
+    ClientPhase phase;
+    ProtoBuffer in;
+    ProtoBuffer out;        // ready to write
+    ProtoBuffer delayed;    // replies still in flight, in order
+    PendingReply pending[SERVER_MAX_PENDING];
+    int pendingHead;
+    int nbPending;
+    int watchingOut;
+    char name[32];
+    Engine* engine;
+    EngineMap* map;
+    EngineRng rng;
+    struct Client* prev;
+    struct Client* next;
+} Client;
+
+typedef struct {
+    const ServerConfig* config;
+    int epollFd;
+    Client* clients;
+    EngineRng rng;          // jitter and per-game seeds
+    int nbClients;
+    long long gamesStarted;
+    long long gamesFinished;
+    long long clientWins;
+    long long movesPlayed;
+} Server;
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onSignal(int signalNumber) {
+    (void)signalNumber;
+    stopRequested = 1;
+}
+
+static long long nowMs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000LL + now.tv_nsec / 1000000;
+}
+
+static void watchClient(Server* server, Client* client) {
+    int wantOut = client->out.length > 0;
+    if (wantOut == client->watchingOut) {
+        return;
+    }
+    
+    struct epoll_event event;
+    event.events = EPOLLIN | (wantOut ? EPOLLOUT : 0);
+    event.data.ptr = client;
+    epoll_ctl(server->epollFd, EPOLL_CTL_MOD, client->fd, &event);
+    client->watchingOut = wantOut;
+}
+
+static void closeClient(Server* server, Client* client) {
+    epoll_ctl(server->epollFd, EPOLL_CTL_DEL, client->fd, NULL);
+    close(client->fd);
+    
+    if (client->prev) client->prev->next = client->next;
+    else server->clients = client->next;
+    if (client->next) client->next->prev = client->prev;
+    
+    freeProtoBuffer(&client->in);
+    freeProtoBuffer(&client->out);
+    freeProtoBuffer(&client->delayed);
+    free(client->engine);
+    free(client->map);
+    free(client);
+    server->nbClients--;
+}
+
+// 0 once the peer is gone
+static int flushClient(Client* client) {
+    while (client->out.length > 0) {
+        ssize_t sent = send(client->fd, client->out.data, client->out.length, MSG_NOSIGNAL);
+        if (sent < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        protoConsume(&client->out, sent);
+    }
+    return 1;
+}
+
+// Replies go straight out, or through the delay queue when latency is injected
+static void reply(Server* server, Client* client, const char* command, const int* values, int count,
+                  const char* payload, int payloadLength) {
+    const ServerConfig* config = server->config;
+    if (config->latencyMs == 0 && config->jitterMs == 0 && client->nbPending == 0) {
+        writeFrame(&client->out, command, values, count, payload, payloadLength);
+        return;
+    }
+    
+    int before = client->delayed.length;
+    if (client->nbPending == SERVER_MAX_PENDING ||
+        !writeFrame(&client->delayed, command, values, count, payload, payloadLength)) {
+        client->delayed.length = before;
+        client->phase = CLIENT_CLOSING;
+        return;
+    }
+    
+    int delay = config->latencyMs;
+    if (config->jitterMs > 0) {
+        delay += randomBelow(&server->rng, 2 * config->jitterMs + 1) - config->jitterMs;
+    }
+    
+    // Never overtake an earlier reply
+    long long readyAt = nowMs() + (delay > 0 ? delay : 0);
+    if (client->nbPending > 0) {
+        const PendingReply* last = &client->pending[(client->pendingHead + client->nbPending - 1) % SERVER_MAX_PENDING];
+        if (last->readyAt > readyAt) readyAt = last->readyAt;
+    }
+    
+    PendingReply* pending = &client->pending[(client->pendingHead + client->nbPending) % SERVER_MAX_PENDING];
+    pending->length = client->delayed.length - before;
+    pending->readyAt = readyAt;
+    client->nbPending++;
+}
+
+static void releaseReplies(Client* client, long long now) {
+    while (client->nbPending > 0 && client->pending[client->pendingHead].readyAt <= now) {
+        PendingReply* pending = &client->pending[client->pendingHead];
+        if (!protoAppend(&client->out, client->delayed.data, pending->length)) {
+            client->phase = CLIENT_CLOSING;
+            return;
+        }
+        protoConsume(&client->delayed, pending->length);
+        client->pendingHead = (client->pendingHead + 1) % SERVER_MAX_PENDING;
+        client->nbPending--;
+    }
+}
+
+static const char* playerName(const Server* server, const Client* client, int player) {
+    if (player == 0) {
+        return client->name;
+    }
+    return server->config->opponent == SCRIPT_GREEDY ? "GreedyBot" : "RandomBot";
+}
+
+// Same shape as the live server summary: totals, ticket lines, longest path
+static int gameSummary(const Server* server, const Client* client, char* message, int size) {
+    const Engine* engine = client->engine;
+    EngineScore scores[ENGINE_PLAYERS];
+    scoreEngineGame(engine, scores);
+    
+    int length = 0;
+    for (int p = 0; p < ENGINE_PLAYERS && length < size; p++) {
+        length += snprintf(message + length, size - length, "%s: Total score: %d pts (routes %d, objectives %d, wagons %d)\n",
+                           playerName(server, client, p), scores[p].total, scores[p].routePoints,
+                           scores[p].objectivePoints, scores[p].wagonsLeft);
+        
+        for (int i = 0; i < engine->nbObjectives[p] && length < size; i++) {
+            const Objective* objective = &engine->objectives[p][i];
+            const char* mark = (scores[p].completedMask >> i) & 1 ? "✔" : "✘";
+            length += snprintf(message + length, size - length, "%s: %sObjective %u-%u (%u)\n",
+                               playerName(server, client, p), mark, objective->from, objective->to, objective->score);
+        }
+    }
+    
+    for (int p = 0; p < ENGINE_PLAYERS && length < size; p++) {
+        if (scores[p].longestBonus > 0) {
+            length += snprintf(message + length, size - length, "Player %s has the longest path (%d)\n",
+                               playerName(server, client, p), scores[p].longestPath);
+        }
+    }
+    return length < size ? length : size - 1;
+}
+
+static void gameOver(Server* server, Client* client) {
+    EngineScore scores[ENGINE_PLAYERS];
+    scoreEngineGame(client->engine, scores);
+    
+    server->gamesFinished++;
+    server->clientWins += scores[0].total > scores[1].total;
+    if (server->config->verbose) {
+        printf("%s: %d - %d in %d turns\n", client->name, scores[0].total, scores[1].total, client->engine->turns);
+    }
+    client->phase = CLIENT_LOBBY;
+}
+
+static void onWaitGame(Server* server, Client* client) {
+    const ServerConfig* config = server->config;
+    
+    if (!client->engine) {
+        client->engine = malloc(sizeof(Engine));
+        client->map = malloc(sizeof(EngineMap));
+        if (!client->engine || !client->map) {
+            client->phase = CLIENT_CLOSING;
+            return;
+        }
+    }
+    
+    seedRng(&client->rng, config->seed ^ nextRandom(&server->rng));
+    const EngineMap* map = config->map;
+    if (!map) {
+        generateEngineMap(client->map, &client->rng, RANDOM_MAP_CITIES, RANDOM_MAP_TRACKS, RANDOM_MAP_TICKETS);
+        map = client->map;
+    }
+    
+    int seed = randomBelow(&client->rng, 1 << 30);
+    int starter = randomBelow(&client->rng, ENGINE_PLAYERS);
+    startEngineGame(client->engine, map, (uint64_t)seed, starter);
+    
+    int count = 8 + map->nbTracks * 5;
+    int* values = malloc(sizeof(int) * count);
+    if (!values) {
+        client->phase = CLIENT_CLOSING;
+        return;
+    }
+    
+    values[0] = seed;
+    values[1] = starter;
+    values[2] = map->nbCities;
+    values[3] = map->nbTracks;
+    for (int i = 0; i < 4; i++) {
+        values[4 + i] = client->engine->startCards[0][i];
+    }
+    memcpy(values + 8, map->trackData, sizeof(int) * map->nbTracks * 5);
+    
+    char gameName[64];
+    int nameLength = snprintf(gameName, sizeof(gameName), "local-%lld", server->gamesStarted++);
+    reply(server, client, "GAME", values, count, gameName, nameLength);
+    free(values);
+    
+    client->phase = CLIENT_PLAYING;
+}
+
+// The face-up row after a move, so clients never need a GET_BOARD to follow refills
+static void putFaceUp(const Client* client, int* values) {
+    for (int i = 0; i < 5; i++) {
+        values[i] = client->engine->faceUp[i];
+    }
+}
+
+static void onGetMove(Server* server, Client* client) {
+    int values[13] = {0};
+    char message[SERVER_MESSAGE_MAX];
+    int messageLength = 0;
+    Engine* engine = client->engine;
+    
+    if (client->phase != CLIENT_PLAYING || engine->current != 1) {
+        values[0] = PARAM_ERROR;
+        messageLength = snprintf(message, sizeof(message), client->phase == CLIENT_PLAYING ?
+                                 "It's our turn, play a move" : "No game in progress");
+        reply(server, client, "MOVE", values, 13, message, messageLength);
+        return;
+    }
+    
+    MoveData move;
+    MoveResult result;
+    scriptedMove(engine, 1, server->config->opponent, &client->rng, &move);
+    MoveState state = playEngineMove(engine, 1, &move, &result);
+    
+    if (state == ILLEGAL_MOVE) {
+        memset(&move, 0, sizeof(MoveData));
+        move.action = DRAW_BLIND_CARD;
+        state = playEngineMove(engine, 1, &move, &result);
+    }
+    
+    // Nothing left to draw or claim: the game stops here
+    if (state == ILLEGAL_MOVE) {
+        engine->over = 1;
+        state = WINNING_MOVE;
+    }
+    server->movesPlayed++;
+    
+    values[0] = ALL_GOOD;
+    values[1] = state;
+    values[2] = result.replay;
+    values[3] = move.action;
+    if (move.action != DRAW_BLIND_CARD && move.action != DRAW_OBJECTIVES) {
+        moveToArgs(&move, values + 4);
+    }
+    putFaceUp(client, values + 8);
+    
+    if (engine->over) {
+        messageLength = gameSummary(server, client, message, sizeof(message));
+        gameOver(server, client);
+    }
+    reply(server, client, "MOVE", values, 13, message, messageLength);
+}
+
+static void onGetBoard(Server* server, Client* client) {
+    int values[6] = {0};
+    
+    if (client->phase != CLIENT_PLAYING) {
+        values[0] = PARAM_ERROR;
+    } else {
+        for (int i = 0; i < 5; i++) {
+            values[1 + i] = client->engine->faceUp[i];
+        }
+    }
+    reply(server, client, "BOARD", values, 6, NULL, 0);
+}
+
+static void onPlayMove(Server* server, Client* client, const ProtoFrame* frame) {
+    int args[5] = {0};
+    int values[18] = {0};
+    char message[SERVER_MESSAGE_MAX];
+    int messageLength = 0;
+    Engine* engine = client->engine;
+    
+    if (client->phase != CLIENT_PLAYING || parseInts(frame->args, args, 5) < 1) {
+        values[0] = PARAM_ERROR;
+        values[1] = ILLEGAL_MOVE;
+        messageLength = snprintf(message, sizeof(message), "No game in progress");
+        reply(server, client, "RESULT", values, 18, message, messageLength);
+        return;
+    }
+    
+    MoveData move;
+    MoveResult result;
+    moveFromArgs(args[0], args + 1, &move);
+    MoveState state = playEngineMove(engine, 0, &move, &result);
+    server->movesPlayed++;
+    
+    values[0] = ALL_GOOD;
+    values[1] = state;
+    values[2] = result.replay;
+    values[3] = result.card;
+    for (int i = 0; i < 3; i++) {
+        values[4 + i * 3] = result.objectives[i].from;
+        values[5 + i * 3] = result.objectives[i].to;
+        values[6 + i * 3] = result.objectives[i].score;
+    }
+    putFaceUp(client, values + 13);
+    
+    if (state == ILLEGAL_MOVE) {
+        messageLength = snprintf(message, sizeof(message), engine->current == 0 ?
+                                 "Illegal move" : "Not your turn");
+    } else if (engine->over) {
+        messageLength = gameSummary(server, client, message, sizeof(message));
+        gameOver(server, client);
+    }
+    reply(server, client, "RESULT", values, 18, message, messageLength);
+}
+
+static void handleFrame(Server* server, Client* client, const ProtoFrame* frame) {
+    if (strcmp(frame->command, "CONNECT") == 0) {
+        int length = frame->payloadLength < (int)sizeof(client->name) - 1 ? frame->payloadLength : (int)sizeof(client->name) - 1;
+        memcpy(client->name, frame->payload, length);
+        client->name[length] = '\0';
+        client->phase = CLIENT_LOBBY;
+        reply(server, client, "OK", NULL, 0, NULL, 0);
+    } else if (client->phase == CLIENT_HELLO) {
+        client->phase = CLIENT_CLOSING;
+    } else if (strcmp(frame->command, "WAIT_GAME") == 0) {
+        onWaitGame(server, client);
+    } else if (strcmp(frame->command, "GET_MOVE") == 0) {
+        onGetMove(server, client);
+    } else if (strcmp(frame->command, "GET_BOARD") == 0) {
+        onGetBoard(server, client);
+    } else if (strcmp(frame->command, "PLAY_MOVE") == 0) {
+        onPlayMove(server, client, frame);
+    } else if (strcmp(frame->command, "QUIT") == 0) {
+        reply(server, client, "BYE", NULL, 0, NULL, 0);
+        client->phase = CLIENT_CLOSING;
+    } else {
+        client->phase = CLIENT_CLOSING;
+    }
+}
+
+// 0 once the connection should be dropped
+static int readClient(Server* server, Client* client) {
+    char chunk[READ_CHUNK];
+    
+    for (;;) {
+        ssize_t received = recv(client->fd, chunk, sizeof(chunk), 0);
+        if (received == 0) {
+            return 0;
+        }
+        if (received < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return 0;
+        }
+        if (!protoAppend(&client->in, chunk, received)) {
+            return 0;
+        }
+    }
+    
+    ProtoFrame frame;
+    int status;
+    while (client->phase != CLIENT_CLOSING && (status = readFrame(&client->in, &frame)) != 0) {
+        if (status < 0) {
+            return 0;
+        }
+        handleFrame(server, client, &frame);
+        protoConsume(&client->in, frame.frameLength);
+    }
+    return 1;
+}
+
+static void acceptClients(Server* server, int listenFd) {
+    for (;;) {
+        int fd = accept(listenFd, NULL, NULL);
+        if (fd < 0) {
+            return;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        
+        Client* client = calloc(1, sizeof(Client));
+        if (!client) {
+            close(fd);
+            continue;
+        }
+        client->fd = fd;
+        client->phase = CLIENT_HELLO;
+        initProtoBuffer(&client->in);
+        initProtoBuffer(&client->out);
+        initProtoBuffer(&client->delayed);
+        
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.ptr = client;
+        if (epoll_ctl(server->epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            close(fd);
+            free(client);
+            continue;
+        }
+        
+        client->next = server->clients;
+        if (server->clients) server->clients->prev = client;
+        server->clients = client;
+        server->nbClients++;
+    }
+}
+
+// Writes what is ready, drops the client when it is gone or done; 0 if it was closed
+static int settleClient(Server* server, Client* client) {
+    if (!flushClient(client) ||
+        (client->phase == CLIENT_CLOSING && client->out.length == 0 && client->nbPending == 0)) {
+        closeClient(server, client);
+        return 0;
+    }
+    watchClient(server, client);
+    return 1;
+}
+
+// Milliseconds until the next delayed reply is due, -1 if none
+static int nextTimeout(const Server* server, long long now) {
+    long long next = -1;
+    for (const Client* client = server->clients; client; client = client->next) {
+        if (client->nbPending > 0) {
+            long long readyAt = client->pending[client->pendingHead].readyAt;
+            if (next < 0 || readyAt < next) next = readyAt;
+        }
+    }
+    
+    if (next < 0) {
+        return -1;
+    }
+    return next > now ? (int)(next - now) : 0;
+}
+
+static int openListener(unsigned int port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    
+    if (bind(fd, (struct sockaddr*)&address, sizeof(address)) < 0 || listen(fd, SERVER_BACKLOG) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int runServer(const ServerConfig* config) {
+    Server server;
+    memset(&server, 0, sizeof(server));
+    server.config = config;
+    seedRng(&server.rng, config->seed);
+    
+    int listenFd = openListener(config->port);
+    server.epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (listenFd < 0 || server.epollFd < 0) {
+        printf("Cannot listen on port %u: %s\n", config->port, strerror(errno));
+        return 1;
+    }
+    
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = NULL;
+    epoll_ctl(server.epollFd, EPOLL_CTL_ADD, listenFd, &event);
+    
+    printf("Listening on port %u (latency %d ms, jitter %d ms, %s opponent)\n", config->port,
+           config->latencyMs, config->jitterMs, config->opponent == SCRIPT_GREEDY ? "greedy" : "random");
+    
+    struct epoll_event events[SERVER_MAX_EVENTS];
+    long long startedAt = nowMs();
+    
+    while (!stopRequested) {
+        int count = epoll_wait(server.epollFd, events, SERVER_MAX_EVENTS, nextTimeout(&server, nowMs()));
+        if (count < 0 && errno != EINTR) {
+            break;
+        }
+        
+        for (int i = 0; i < count; i++) {
+            Client* client = events[i].data.ptr;
+            if (!client) {
+                acceptClients(&server, listenFd);
+                continue;
+            }
+            
+            if ((events[i].events & (EPOLLERR | EPOLLHUP)) ||
+                ((events[i].events & EPOLLIN) && !readClient(&server, client))) {
+                closeClient(&server, client);
+                continue;
+            }
+            settleClient(&server, client);
+        }
+        
+        long long now = nowMs();
+        Client* next;
+        for (Client* client = server.clients; client; client = next) {
+            next = client->next;
+            if (client->nbPending > 0 && client->pending[client->pendingHead].readyAt <= now) {
+                releaseReplies(client, now);
+                settleClient(&server, client);
+            }
+        }
+    }
+    
+    double seconds = (nowMs() - startedAt) / 1000.0;
+    printf("\n%lld games started, %lld finished (client won %lld), %lld moves in %.1fs (%.0f moves/s)\n",
+           server.gamesStarted, server.gamesFinished, server.clientWins, server.movesPlayed,
+           seconds, seconds > 0 ? server.movesPlayed / seconds : 0);
+    
+    while (server.clients) {
+        closeClient(&server, server.clients);
+    }
+    close(server.epollFd);
+    close(listenFd);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    static EngineMap fixedMap;
+    ServerConfig config = {DEFAULT_PORT, 0, 0, SCRIPT_GREEDY, NULL, (uint64_t)time(NULL), 0};
+    int option;
+    
+    while ((option = getopt(argc, argv, "p:l:j:o:m:s:v")) != -1) {
+        switch (option) {
+            case 'p':
+                config.port = atoi(optarg);
+                break;
+            case 'l':
+                config.latencyMs = atoi(optarg);
+                break;
+            case 'j':
+                config.jitterMs = atoi(optarg);
+                break;
+            case 'o':
+                if (strcmp(optarg, "greedy") == 0) {
+                    config.opponent = SCRIPT_GREEDY;
+                } else if (strcmp(optarg, "random") == 0) {
+                    config.opponent = SCRIPT_RANDOM;
+                } else {
+                    printf("Unknown opponent %s (greedy or random)\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'm':
+                if (!loadEngineMap(&fixedMap, optarg)) {
+                    return 1;
+                }
+                config.map = &fixedMap;
+                break;
+            case 's':
+                config.seed = strtoull(optarg, NULL, 10);
+                break;
+            case 'v':
+                config.verbose = 1;
+                break;
+            default:
+                printf("Usage: %s [-p port] [-l latency ms] [-j jitter ms] [-o greedy|random] [-m map file] [-s seed] [-v]\n", argv[0]);
+                return 1;
+        }
+    }
+    
+    if (config.latencyMs < 0 || config.jitterMs < 0) {
+        printf("Latency and jitter must be positive\n");
+        return 1;
+    }
+    
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    signal(SIGPIPE, SIG_IGN);
+    return runServer(&config);
+}
\ No newline at end of file
@@ -0,0 +1,678 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <netdb.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include "session.h"
+#include "player.h"
+#include "rules.h"
+#include "protocol.h"
+#include "msgpool.h"
+#include "machine.h"
+
+#define SESSION_MAX_EVENTS 64
+
+// Where each game is in its exchange with the server
+typedef enum {
+    SESSION_CONNECTING,
+    SESSION_HELLO,       // CONNECT sent
+    SESSION_WAIT_GAME,   // WAIT_GAME sent
+    SESSION_WAIT_MOVE,   // GET_MOVE sent, opponent playing
+    SESSION_BOARD,       // GET_BOARD sent, our turn
+    SESSION_THINKING,    // owned by a worker
+    SESSION_PLAY,        // PLAY_MOVE sent
+    SESSION_GAME_OVER,   // game finished, nothing in flight
+    SESSION_QUIT,        // QUIT sent
+    SESSION_DONE
+} SessionPhase;
+
+typedef struct Session {
+    int gameNumber;
+    int fd;
+    SessionPhase phase;
+    ProtoBuffer in;
+    ProtoBuffer out;
+    
+    GameContext* game;
+    GameData gameData;
+    TurnMachine machine;   // the same phases as the sequential mode
+    int finished;          // game over seen, ended by the server or given up
+    int hangup;            // connection lost while a worker had the session
+    
+    MessagePool* messages;
+    MessageBuffer* message;  // borrowed when the game ends, end-of-game scores
+    
+    struct Session* nextDone;
+    struct Session* nextRetired;
+} Session;
+
+// Decisions run off the I/O thread; a session belongs to at most one side at a time
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    Session** queue;
+    int capacity;
+    int head;
+    int count;
+    Session* done;
+    int eventFd;
+    int stopping;
+    pthread_t* threads;
+    int nbThreads;
+} WorkerPool;
+
+// Our score is the server's when its summary names us, the local estimate otherwise
+void fillGameResult(GameResult* result, int gameNumber, GameState* state, const char* serverMessage,
+                    const char* playerName) {
+    int completedObjectives = 0;
+    for (int i = 0; i < state->nbObjectives; i++) {
+        if (isObjectiveCompleted(state, state->objectives[i])) {
+            completedObjectives++;
+        }
+    }
+    
+    result->gameNumber = gameNumber;
+    result->finalScore = calculateScore(state);
+    result->wagonsLeft = state->wagonsLeft;
+    result->objectivesCompleted = completedObjectives;
+    result->totalObjectives = state->nbObjectives;
+    
+    parseMatchResults(serverMessage, &result->serverResults);
+    const PlayerResult* ours = findPlayerResult(&result->serverResults, playerName);
+    result->hasServerResults = ours != NULL;
+    
+    if (ours) {
+        result->finalScore = ours->score;
+    }
+}
+
+static void* workerMain(void* arg) {
+    WorkerPool* pool = arg;
+    
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        while (pool->count == 0 && !pool->stopping) {
+            pthread_cond_wait(&pool->ready, &pool->lock);
+        }
+        if (pool->count == 0) {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        Session* session = pool->queue[pool->head];
+        pool->head = (pool->head + 1) % pool->capacity;
+        pool->count--;
+        pthread_mutex_unlock(&pool->lock);
+        
+        decideTurn(&session->machine);
+        
+        pthread_mutex_lock(&pool->lock);
+        session->nextDone = pool->done;
+        pool->done = session;
+        pthread_mutex_unlock(&pool->lock);
+        
+        uint64_t one = 1;
+        if (write(pool->eventFd, &one, sizeof(one)) < 0) {
+            perror("eventfd write");
+        }
+    }
+}
+
+static int startWorkers(WorkerPool* pool, int nbThreads, int capacity) {
+    memset(pool, 0, sizeof(WorkerPool));
+    pool->queue = malloc(sizeof(Session*) * capacity);
+    pool->threads = malloc(sizeof(pthread_t) * nbThreads);
+    pool->capacity = capacity;
+    pool->eventFd = eventfd(0, EFD_NONBLOCK);
+    if (!pool->queue || !pool->threads || pool->eventFd < 0) {
+        return 0;
+    }
+    
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->ready, NULL);
+    for (int i = 0; i < nbThreads; i++) {
+        if (pthread_create(&pool->threads[i], NULL, workerMain, pool) != 0) {
+            break;
+        }
+        pool->nbThreads++;
+    }
+    return pool->nbThreads > 0;
+}
+
+static void stopWorkers(WorkerPool* pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = 1;
+    pthread_cond_broadcast(&pool->ready);
+    pthread_mutex_unlock(&pool->lock);
+    
+    for (int i = 0; i < pool->nbThreads; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->ready);
+    if (pool->eventFd >= 0) close(pool->eventFd);
+    free(pool->queue);
+    free(pool->threads);
+}
+
+static void submitJob(WorkerPool* pool, Session* session) {
+    session->phase = SESSION_THINKING;
+    
+    pthread_mutex_lock(&pool->lock);
+    pool->queue[(pool->head + pool->count) % pool->capacity] = session;
+    pool->count++;
+    pthread_cond_signal(&pool->ready);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static int connectNonBlocking(const char* host, unsigned int port) {
+    char service[16];
+    snprintf(service, sizeof(service), "%u", port);
+    
+    struct addrinfo hints;
+    struct addrinfo* addresses;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, service, &hints, &addresses) != 0) {
+        return -1;
+    }
+    
+    int fd = -1;
+    for (struct addrinfo* a = addresses; a && fd < 0; a = a->ai_next) {
+        fd = socket(a->ai_family, a->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, a->ai_protocol);
+        if (fd < 0) continue;
+        
+        if (connect(fd, a->ai_addr, a->ai_addrlen) < 0 && errno != EINPROGRESS) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    
+    freeaddrinfo(addresses);
+    return fd;
+}
+
+static void sendFrame(Session* session, const char* command, const int* values, int count, const char* payload, int payloadLength) {
+    if (!writeFrame(&session->out, command, values, count, payload, payloadLength)) {
+        session->phase = SESSION_DONE;
+    }
+}
+
+static void sendMoveFrame(Session* session) {
+    int values[5];
+    values[0] = session->machine.move.action;
+    moveToArgs(&session->machine.move, values + 1);
+    session->phase = SESSION_PLAY;
+    sendFrame(session, "PLAY_MOVE", values, 5, NULL, 0);
+}
+
+// Frames are read in place; only the one ending the game has its message copied out
+static void keepMessage(Session* session, const ProtoFrame* frame) {
+    if (!frame || frame->payloadLength <= 0) {
+        return;
+    }
+    
+    if (!session->message) {
+        session->message = borrowMessage(session->messages);
+        if (!session->message) {
+            return;
+        }
+    }
+    setMessage(session->message, frame->payload, frame->payloadLength);
+}
+
+static void askGame(Session* session, const SessionConfig* config) {
+    session->phase = SESSION_WAIT_GAME;
+    sendFrame(session, "WAIT_GAME", NULL, 0, config->settings, strlen(config->settings));
+}
+
+// Same connection, fresh game: only the per-game state is reset
+static void startNextGame(Session* session, int gameNumber, const SessionConfig* config) {
+    free(session->gameData.gameName);
+    free(session->gameData.trackData);
+    memset(&session->gameData, 0, sizeof(GameData));
+    returnMessage(session->messages, session->message);
+    session->message = NULL;
+    
+    session->gameNumber = gameNumber;
+    session->finished = 0;
+    askGame(session, config);
+}
+
+// Sends the request the machine names or hands it to a worker. At game over the
+// connection stays open: the loop decides between the next game and QUIT
+static void advanceSession(Session* session, WorkerPool* pool) {
+    switch (nextTurnNeed(&session->machine)) {
+        case TURN_NEED_MOVE:
+            session->phase = SESSION_WAIT_MOVE;
+            sendFrame(session, "GET_MOVE", NULL, 0, NULL, 0);
+            break;
+        case TURN_NEED_BOARD:
+            session->phase = SESSION_BOARD;
+            sendFrame(session, "GET_BOARD", NULL, 0, NULL, 0);
+            break;
+        case TURN_NEED_DECISION:
+            submitJob(pool, session);
+            break;
+        case TURN_NEED_SEND:
+            sendMoveFrame(session);
+            break;
+        default:
+            session->finished = 1;
+            session->phase = SESSION_GAME_OVER;
+            break;
+    }
+}
+
+static void onGame(Session* session, WorkerPool* pool, const ProtoFrame* frame) {
+    if (!parseGameFrame(frame, &session->gameData)) {
+        printf("Game %d: bad game description\n", session->gameNumber);
+        session->phase = SESSION_DONE;
+        return;
+    }
+    
+    initPlayer(session->game, &session->gameData);
+    startTurnMachine(&session->machine, session->gameNumber, session->game, session->gameData.starter);
+    advanceSession(session, pool);
+}
+
+static void setBoardFromArgs(TurnAnswer* answer, const int* values) {
+    for (int i = 0; i < 5; i++) {
+        answer->board[i] = values[i];
+    }
+    answer->hasBoard = 1;
+}
+
+// Hands the answer to the machine; the message of the frame that ended the game is kept
+static void answerSession(Session* session, WorkerPool* pool, const ProtoFrame* frame, TurnAnswer* answer) {
+    answer->message = frame->payloadLength > 0 ? frame->payload : NULL;
+    answer->messageLength = frame->payloadLength;
+    
+    answerTurn(&session->machine, answer);
+    if (session->machine.phase == TURN_GAME_OVER && !session->machine.aborted) {
+        keepMessage(session, frame);
+    }
+    advanceSession(session, pool);
+}
+
+static void onOpponentMove(Session* session, WorkerPool* pool, const ProtoFrame* frame) {
+    int values[13];
+    int count = parseInts(frame->args, values, 13);
+    if (count != 8 && count != 13) {
+        session->phase = SESSION_DONE;
+        return;
+    }
+    
+    TurnAnswer answer;
+    memset(&answer, 0, sizeof(TurnAnswer));
+    answer.code = values[0];
+    answer.result.state = values[1];
+    answer.result.replay = values[2] != 0;
+    moveFromArgs(values[3], values + 4, &answer.move);
+    if (count == 13) {
+        setBoardFromArgs(&answer, values + 8);
+    }
+    answerSession(session, pool, frame, &answer);
+}
+
+static void onBoard(Session* session, WorkerPool* pool, const ProtoFrame* frame) {
+    int values[6];
+    if (parseInts(frame->args, values, 6) != 6) {
+        session->phase = SESSION_DONE;
+        return;
+    }
+    
+    TurnAnswer answer;
+    memset(&answer, 0, sizeof(TurnAnswer));
+    answer.code = values[0];
+    setBoardFromArgs(&answer, values + 1);
+    answerSession(session, pool, frame, &answer);
+}
+
+static void onMoveResult(Session* session, WorkerPool* pool, const ProtoFrame* frame) {
+    int values[18];
+    int count = parseInts(frame->args, values, 18);
+    if (count != 13 && count != 18) {
+        session->phase = SESSION_DONE;
+        return;
+    }
+    
+    TurnAnswer answer;
+    memset(&answer, 0, sizeof(TurnAnswer));
+    answer.code = values[0];
+    resultFromArgs(values + 1, &answer.result);
+    if (count == 18) {
+        setBoardFromArgs(&answer, values + 13);
+    }
+    answerSession(session, pool, frame, &answer);
+}
+
+static void handleFrame(Session* session, WorkerPool* pool, const SessionConfig* config, const ProtoFrame* frame) {
+    const char* expected[] = {
+        [SESSION_HELLO] = "OK",
+        [SESSION_WAIT_GAME] = "GAME",
+        [SESSION_WAIT_MOVE] = "MOVE",
+        [SESSION_BOARD] = "BOARD",
+        [SESSION_PLAY] = "RESULT",
+        [SESSION_QUIT] = "BYE",
+    };
+    
+    if (session->phase > SESSION_QUIT || !expected[session->phase] ||
+        strcmp(frame->command, expected[session->phase]) != 0) {
+        printf("Game %d: unexpected %s from server\n", session->gameNumber, frame->command);
+        session->phase = SESSION_DONE;
+        return;
+    }
+    
+    switch (session->phase) {
+        case SESSION_HELLO:
+            askGame(session, config);
+            break;
+        case SESSION_WAIT_GAME:
+            onGame(session, pool, frame);
+            break;
+        case SESSION_WAIT_MOVE:
+            onOpponentMove(session, pool, frame);
+            break;
+        case SESSION_BOARD:
+            onBoard(session, pool, frame);
+            break;
+        case SESSION_PLAY:
+            onMoveResult(session, pool, frame);
+            break;
+        case SESSION_QUIT:
+            session->phase = SESSION_DONE;
+            break;
+        default:
+            break;
+    }
+}
+
+static int flushSession(Session* session) {
+    while (session->out.length > 0) {
+        ssize_t sent = send(session->fd, session->out.data, session->out.length, MSG_NOSIGNAL);
+        if (sent < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        protoConsume(&session->out, sent);
+    }
+    return 1;
+}
+
+// No EPOLLIN while a worker thinks: nothing is read until the decision is back
+static void watchSession(int epollFd, Session* session, int op) {
+    struct epoll_event event;
+    event.events = (session->phase == SESSION_THINKING ? 0 : EPOLLIN) |
+                   (session->out.length > 0 || session->phase == SESSION_CONNECTING ? EPOLLOUT : 0);
+    event.data.ptr = session;
+    epoll_ctl(epollFd, op, session->fd, &event);
+}
+
+static Session* openSession(const SessionConfig* config, MessagePool* messages, int gameNumber, int epollFd) {
+    Session* session = calloc(1, sizeof(Session));
+    if (!session) {
+        return NULL;
+    }
+    
+    session->game = malloc(sizeof(GameContext));
+    session->fd = connectNonBlocking(config->host, config->port);
+    if (!session->game || session->fd < 0) {
+        printf("Connection failed for game %d\n", gameNumber);
+        free(session->game);
+        free(session);
+        return NULL;
+    }
+    
+    session->gameNumber = gameNumber;
+    session->messages = messages;
+    session->phase = SESSION_CONNECTING;
+    initProtoBuffer(&session->in);
+    initProtoBuffer(&session->out);
+    
+    sendFrame(session, "CONNECT", NULL, 0, config->playerName, strlen(config->playerName));
+    watchSession(epollFd, session, EPOLL_CTL_ADD);
+    return session;
+}
+
+// Closed now, freed once the current batch of events is handled: a later event
+// of the same batch may still point at it
+static void retireSession(Session* session, int epollFd, Session** retired) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, session->fd, NULL);
+    close(session->fd);
+    session->fd = -1;
+    session->phase = SESSION_DONE;
+    session->nextRetired = *retired;
+    *retired = session;
+}
+
+// The connection is gone while a worker has the session: stop watching it, it is
+// retired once handed back
+static void markHangup(Session* session, int epollFd) {
+    session->hangup = 1;
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, session->fd, NULL);
+}
+
+static void freeSession(Session* session) {
+    freeProtoBuffer(&session->in);
+    freeProtoBuffer(&session->out);
+    returnMessage(session->messages, session->message);
+    free(session->gameData.gameName);
+    free(session->gameData.trackData);
+    free(session->game);
+    free(session);
+}
+
+static void readSession(Session* session, WorkerPool* pool, const SessionConfig* config) {
+    char chunk[4096];
+    
+    for (;;) {
+        ssize_t received = recv(session->fd, chunk, sizeof(chunk), 0);
+        if (received == 0) {
+            session->phase = SESSION_DONE;
+            return;
+        }
+        if (received < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                session->phase = SESSION_DONE;
+            }
+            break;
+        }
+        if (!protoAppend(&session->in, chunk, received)) {
+            session->phase = SESSION_DONE;
+            return;
+        }
+    }
+    
+    ProtoFrame frame;
+    int status;
+    while (session->phase != SESSION_DONE && session->phase != SESSION_THINKING &&
+           (status = readFrame(&session->in, &frame)) != 0) {
+        if (status < 0) {
+            session->phase = SESSION_DONE;
+            return;
+        }
+        
+        handleFrame(session, pool, config, &frame);
+        protoConsume(&session->in, frame.frameLength);
+    }
+}
+
+static void recordResult(Session* session, const SessionConfig* config, GameResult* results, int* completed) {
+    if (session->finished && session->game->state.nbCities > 0) {
+        fillGameResult(&results[*completed], session->gameNumber, &session->game->state,
+                       session->message ? session->message->data : NULL, config->playerName);
+        printf("Game %d %s: score %d\n", session->gameNumber,
+               session->machine.aborted ? "abandoned" : "finished", results[*completed].finalScore);
+        (*completed)++;
+    } else {
+        printf("Game %d aborted\n", session->gameNumber);
+    }
+    session->finished = 0;
+    session->gameNumber = 0;
+}
+
+// Record a finished game and chain the next one on the same connection, unless it was
+// given up and the server may still be running it; flush what the session queued,
+// then re-arm it or retire it
+static void settleSession(Session* session, int epollFd, const SessionConfig* config, GameResult* results,
+                          int* completed, int* active, int* started, Session** retired) {
+    if (session->phase == SESSION_GAME_OVER) {
+        recordResult(session, config, results, completed);
+        
+        if (!config->reconnect && !session->machine.aborted && *started < config->nbGames) {
+            startNextGame(session, ++(*started), config);
+        } else {
+            session->phase = SESSION_QUIT;
+            sendFrame(session, "QUIT", NULL, 0, NULL, 0);
+        }
+    }
+    
+    if (session->phase != SESSION_DONE && session->phase != SESSION_CONNECTING && !flushSession(session)) {
+        if (session->phase == SESSION_THINKING) {
+            markHangup(session, epollFd);
+            return;
+        }
+        session->phase = SESSION_DONE;
+    }
+    
+    if (session->phase != SESSION_DONE) {
+        watchSession(epollFd, session, EPOLL_CTL_MOD);
+        return;
+    }
+    
+    if (session->gameNumber > 0) {
+        recordResult(session, config, results, completed);
+    }
+    
+    retireSession(session, epollFd, retired);
+    (*active)--;
+}
+
+int runSessions(const SessionConfig* config, GameResult* results) {
+    int nbParallel = config->nbParallel < config->nbGames ? config->nbParallel : config->nbGames;
+    if (nbParallel <= 0) {
+        return 0;
+    }
+    
+    // One message buffer per game in flight, so finished games never allocate
+    MessagePool messages;
+    if (!initMessagePool(&messages, nbParallel)) {
+        return 0;
+    }
+    
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    WorkerPool pool;
+    if (epollFd < 0 || !startWorkers(&pool, config->nbWorkers > 0 ? config->nbWorkers : 1, nbParallel)) {
+        printf("Cannot start the session loop\n");
+        if (epollFd >= 0) close(epollFd);
+        freeMessagePool(&messages);
+        return 0;
+    }
+    
+    struct epoll_event poolEvent;
+    poolEvent.events = EPOLLIN;
+    poolEvent.data.ptr = NULL;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, pool.eventFd, &poolEvent);
+    
+    int started = 0;
+    int active = 0;
+    int completed = 0;
+    
+    while (started < config->nbGames || active > 0) {
+        while (active < nbParallel && started < config->nbGames) {
+            started++;
+            if (openSession(config, &messages, started, epollFd)) {
+                active++;
+            }
+        }
+        if (active == 0) {
+            continue;
+        }
+        
+        struct epoll_event events[SESSION_MAX_EVENTS];
+        int nbEvents = epoll_wait(epollFd, events, SESSION_MAX_EVENTS, -1);
+        if (nbEvents < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        
+        Session* retired = NULL;
+        for (int e = 0; e < nbEvents; e++) {
+            Session* session = events[e].data.ptr;
+            
+            // Decisions handed back by the workers
+            if (!session) {
+                uint64_t ticks;
+                if (read(pool.eventFd, &ticks, sizeof(ticks)) < 0 && errno != EAGAIN) {
+                    perror("eventfd read");
+                }
+                
+                pthread_mutex_lock(&pool.lock);
+                Session* done = pool.done;
+                pool.done = NULL;
+                pthread_mutex_unlock(&pool.lock);
+                
+                while (done) {
+                    Session* next = done->nextDone;
+                    if (done->hangup) {
+                        done->phase = SESSION_DONE;
+                    } else {
+                        advanceSession(done, &pool);
+                    }
+                    settleSession(done, epollFd, config, results, &completed, &active, &started, &retired);
+                    done = next;
+                }
+                continue;
+            }
+            
+            // Retired earlier in this batch
+            if (session->phase == SESSION_DONE) {
+                continue;
+            }
+            
+            // A worker owns it: never read, only finish sending or note a hangup
+            if (session->phase == SESSION_THINKING) {
+                if (events[e].events & (EPOLLHUP | EPOLLERR)) {
+                    markHangup(session, epollFd);
+                } else {
+                    settleSession(session, epollFd, config, results, &completed, &active, &started, &retired);
+                }
+                continue;
+            }
+            
+            if (session->phase == SESSION_CONNECTING) {
+                int error = 0;
+                socklen_t length = sizeof(error);
+                getsockopt(session->fd, SOL_SOCKET, SO_ERROR, &error, &length);
+                if (error != 0) {
+                    printf("Connection failed for game %d\n", session->gameNumber);
+                }
+                session->phase = error == 0 ? SESSION_HELLO : SESSION_DONE;
+            }
+            
+            if (session->phase != SESSION_DONE && (events[e].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) {
+                readSession(session, &pool, config);
+            }
+            
+            settleSession(session, epollFd, config, results, &completed, &active, &started, &retired);
+        }
+        
+        while (retired) {
+            Session* next = retired->nextRetired;
+            freeSession(retired);
+            retired = next;
+        }
+    }
+    
+    stopWorkers(&pool);
+    close(epollFd);
+    freeMessagePool(&messages);
+    return completed;
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#ifndef SESSION_H
+#define SESSION_H
+#include <stdbool.h>
+#include "gamestate.h"
+#include "msgclass.h"
+#include "../tickettorideapi/ticketToRide.h"
+
+typedef struct {
+    int gameNumber;
+    int finalScore;
+    int wagonsLeft;
+    int objectivesCompleted;
+    int totalObjectives;
+    MatchResults serverResults;  // parsed end-of-game message
+    bool hasServerResults;       // our own line was found in it
+} GameResult;
+
+typedef struct {
+    const char* host;
+    unsigned int port;
+    const char* playerName;
+    const char* settings;
+    int nbGames;
+    int nbParallel;   // games in flight at once
+    int lineProtocol; // in one process over the line protocol (t2rserver), not the client API
+    int nbWorkers;    // decision threads
+    int reconnect;    // new connection for every game instead of chaining them
+} SessionConfig;
+
+void fillGameResult(GameResult* result, int gameNumber, GameState* state, const char* serverMessage,
+                    const char* playerName);
+int runSessions(const SessionConfig* config, GameResult* results);
+
+#endif
\ No newline at end of file
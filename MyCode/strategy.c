@@ -1,13 +1,75 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <limits.h>
+#include <string.h>
 #include "strategy.h"
 #include "rules.h"
 #include "gamestate.h"
+#include "contention.h"
+#include "chokepoints.h"
+#include "reachability.h"
+#include "portfolio.h"
+#include "analysis.h"
+#include "topology.h"
+#include "pathcost.h"
+#include "segments.h"
+#include "hierarchy.h"
+#include "book.h"
 
-static int currentObjectiveIndex = -1;
-static int currentPath[MAX_CITIES];
-static int currentPathLength = 0;
+#define TOP_ROUTES 5
+#define OPENING_BOOK_TURNS 8  // turns spent collecting cards for a book claim
+
+typedef struct {
+    int index;
+    int priority;
+} RouteAnalysis;
+
+// Min-heap order: the weakest kept route sits at the root
+static int routeWeaker(RouteAnalysis a, RouteAnalysis b) {
+    return a.priority < b.priority || (a.priority == b.priority && a.index > b.index);
+}
+
+static void siftDownRoute(RouteAnalysis* heap, int count, int i) {
+    while (1) {
+        int weakest = i;
+        int left = 2 * i + 1;
+        int right = 2 * i + 2;
+        if (left < count && routeWeaker(heap[left], heap[weakest])) weakest = left;
+        if (right < count && routeWeaker(heap[right], heap[weakest])) weakest = right;
+        if (weakest == i) return;
+        
+        RouteAnalysis temp = heap[i];
+        heap[i] = heap[weakest];
+        heap[weakest] = temp;
+        i = weakest;
+    }
+}
+
+// Keeps the TOP_ROUTES best entries seen so far
+static void pushTopRoute(RouteAnalysis* heap, int* count, RouteAnalysis entry) {
+    if (*count == TOP_ROUTES) {
+        if (routeWeaker(entry, heap[0])) return;
+        heap[0] = entry;
+        siftDownRoute(heap, *count, 0);
+        return;
+    }
+    
+    int i = (*count)++;
+    heap[i] = entry;
+    while (i > 0 && routeWeaker(heap[i], heap[(i - 1) / 2])) {
+        RouteAnalysis temp = heap[i];
+        heap[i] = heap[(i - 1) / 2];
+        heap[(i - 1) / 2] = temp;
+        i = (i - 1) / 2;
+    }
+}
+
+static RouteAnalysis popTopRoute(RouteAnalysis* heap, int* count) {
+    RouteAnalysis weakest = heap[0];
+    heap[0] = heap[--(*count)];
+    siftDownRoute(heap, *count, 0);
+    return weakest;
+}
 
 int findBestObjective(GameState* state);
 int canTakeRoute(GameState* state, int from, int to, MoveData* moveData);
@@ -15,18 +77,20 @@ int drawCardsForRoute(GameState* state, int from, int to, MoveData* moveData);
 int drawBestCard(GameState* state, MoveData* moveData);
 void simpleChooseObjectives(GameState* state, Objective* objectives, unsigned char* chooseObjectives);
 int getRouteOwner(GameState* state, int from, int to);
-int workOnObjectives(GameState* state, MoveData* moveData);
-int workOnSingleObjective(GameState* state, MoveData* moveData);
-int analyzeAllObjectivesAndAct(GameState* state, MoveData* moveData);
-int buildLongestRoute(GameState* state, MoveData* moveData);
-int takeAnyGoodRoute(GameState* state, MoveData* moveData);
-int handleEndgame(GameState* state, MoveData* moveData);
-int handleLateGame(GameState* state, MoveData* moveData);
-int takeHighestValueRoute(GameState* state, MoveData* moveData);
-int emergencyUnblock(GameState* state, MoveData* moveData);
-int alternativeStrategy(GameState* state, MoveData* moveData, void* objData, int objectiveCount);
+int workOnObjectives(GameState* state, StrategyContext* ctx, MoveData* moveData);
+int workOnSingleObjective(GameState* state, StrategyContext* ctx, MoveData* moveData);
+int analyzeAllObjectivesAndAct(GameState* state, StrategyContext* ctx, MoveData* moveData);
+int buildLongestRoute(GameState* state, StrategyContext* ctx, MoveData* moveData);
+int takeAnyGoodRoute(GameState* state, StrategyContext* ctx, MoveData* moveData);
+int handleEndgame(GameState* state, StrategyContext* ctx, MoveData* moveData);
+int raceToEnd(GameState* state, StrategyContext* ctx, MoveData* moveData);
+int followOpeningBook(GameState* state, StrategyContext* ctx, MoveData* moveData);
+int handleLateGame(GameState* state, StrategyContext* ctx, MoveData* moveData);
+int takeHighestValueRoute(GameState* state, StrategyContext* ctx, MoveData* moveData);
+int emergencyUnblock(GameState* state, StrategyContext* ctx, MoveData* moveData);
+int alternativeStrategy(GameState* state, StrategyContext* ctx, MoveData* moveData, void* objData, int objectiveCount);
 int findAlternativePath(GameState* state, int from, int to, MoveData* moveData);
-int findNearestCompletionObjective(GameState* state);
+int findNearestCompletionObjective(GameState* state, StrategyContext* ctx);
 int drawCardsForRouteAggressively(GameState* state, int from, int to, MoveData* moveData);
 
 // Pathfinding avec Dijkstra modifié
@@ -36,6 +100,11 @@ int findSmartestPath(GameState* state, int start, int end, int* path, int* pathL
         return -1;
     }
     
+    // Same costs answered from the contraction hierarchy when it is built
+    if (hierarchyReady(state)) {
+        return hierarchyPath(state, start, end, path, pathLength);
+    }
+    
     int dist[MAX_CITIES];
     int prev[MAX_CITIES];
     int visited[MAX_CITIES];
@@ -123,7 +192,7 @@ void simpleChooseObjectives(GameState* state, Objective* objectives, unsigned ch
         int distance;
         int score;
         float efficiency;
-        int isEastCoast;
+        int isRemote;
         int usesNetwork;
         int routesNeeded;
         float finalScore;
@@ -131,29 +200,18 @@ void simpleChooseObjectives(GameState* state, Objective* objectives, unsigned ch
     
     ObjectiveEval evals[3];
     
-    // East coast cities to avoid
-    int eastCoastCities[] = {
-        30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
-        20, 21, 22, 23, 24, 25, 26, 27, 28, 29
-    };
-    int numEastCities = sizeof(eastCoastCities) / sizeof(eastCoastCities[0]);
-    
     for (int i = 0; i < 3; i++) {
         evals[i].index = i;
         evals[i].score = objectives[i].score;
-        evals[i].isEastCoast = 0;
+        evals[i].isRemote = 0;
         evals[i].usesNetwork = 0;
         evals[i].routesNeeded = 999;
         
         int from = objectives[i].from;
         int to = objectives[i].to;
         
-        for (int j = 0; j < numEastCities; j++) {
-            if (from == eastCoastCities[j] || to == eastCoastCities[j]) {
-                evals[i].isEastCoast = 1;
-                break;
-            }
-        }
+        // Endpoints in regions costly to connect to the rest of the map
+        evals[i].isRemote = isRemoteCity(state, from) || isRemoteCity(state, to);
         
         int path[MAX_CITIES];
         int pathLength = 0;
@@ -163,7 +221,6 @@ void simpleChooseObjectives(GameState* state, Objective* objectives, unsigned ch
         
         if (distance > 0) {
             int routesOwned = 0;
-            int totalRoutes = pathLength - 1;
             
             for (int j = 0; j < pathLength - 1; j++) {
                 int cityA = path[j];
@@ -174,14 +231,14 @@ void simpleChooseObjectives(GameState* state, Objective* objectives, unsigned ch
                 }
             }
             
-            evals[i].routesNeeded = totalRoutes - routesOwned;
+            evals[i].routesNeeded = segmentsNeeded(state, from, to);
             evals[i].usesNetwork = (routesOwned > 0) ? 1 : 0;
             
             float baseEfficiency = (float)evals[i].score / distance;
             evals[i].finalScore = baseEfficiency;
             
             // Apply penalties and bonuses
-            if (evals[i].isEastCoast) {
+            if (evals[i].isRemote) {
                 evals[i].finalScore *= 0.3f;
             }
             
@@ -243,102 +300,153 @@ void simpleChooseObjectives(GameState* state, Objective* objectives, unsigned ch
     }
 }
 
-int simpleStrategy(GameState* state, MoveData* moveData) {
+int simpleStrategy(GameState* state, StrategyContext* ctx, MoveData* moveData) {
     if (state->nbObjectives == 0) {
         moveData->action = DRAW_OBJECTIVES;
         return 1;
     }
     
-    if (isAntiAdversaireMode(state)) {
-        return handleAntiAdversaire(state, moveData);
+    if (state->nbOpeningClaims > 0 && followOpeningBook(state, ctx, moveData)) {
+        return 1;
+    }
+    
+    TempoModel* tempo = &ctx->turnAnalysis.tempo;
+    
+    if (tempo->mode == TEMPO_RACE) {
+        return raceToEnd(state, ctx, moveData);
+    }
+    
+    if (isAntiAdversaireMode(state, ctx)) {
+        return handleAntiAdversaire(state, ctx, moveData);
     }
 
-    int isEndgame = (state->lastTurn || state->wagonsLeft <= 3 || state->opponentWagonsLeft <= 3);
-    int isLateGame = (state->wagonsLeft <= 8 || state->opponentWagonsLeft <= 8);
+    int isEndgame = (state->lastTurn || tempo->turnsRemaining <= 1);
+    int isLateGame = (tempo->turnsRemaining <= 4);
     
     if (isEndgame) {
-        return handleEndgame(state, moveData);
+        return handleEndgame(state, ctx, moveData);
     }
     
     if (isLateGame) {
-        return handleLateGame(state, moveData);
+        return handleLateGame(state, ctx, moveData);
+    }
+    
+    // More tickets when our network already reaches most of the map
+    if (estimateObjectiveDrawValue(state) > 0) {
+        moveData->action = DRAW_OBJECTIVES;
+        return 1;
     }
     
     int completedCount = 0;
     int totalObjectives = state->nbObjectives;
     
+    // Objectives the opponent has cut off are dropped, not retried
     for (int i = 0; i < state->nbObjectives; i++) {
-        if (isObjectiveCompleted(state, state->objectives[i])) {
+        if (!isObjectiveOpen(state, state->objectives[i])) {
             completedCount++;
         }
     }
     
     if (completedCount == totalObjectives) {
-        return buildLongestRoute(state, moveData);
+        return buildLongestRoute(state, ctx, moveData);
+    }
+    
+    return workOnObjectives(state, ctx, moveData);
+}
+
+// Book claims in order; taken ones are skipped, the line is dropped once it goes stale
+int followOpeningBook(GameState* state, StrategyContext* ctx, MoveData* moveData) {
+    while (state->nbOpeningClaims > 0) {
+        int routeIndex = state->openingClaims[0];
+        
+        if (state->routes[routeIndex].owner == 0) {
+            if (claimAnalyzedRoute(state, &ctx->turnAnalysis, routeIndex, moveData)) {
+                return 1;
+            }
+            if (state->turnCount <= OPENING_BOOK_TURNS) {
+                return drawCardsForRoute(state, state->routes[routeIndex].from, state->routes[routeIndex].to, moveData);
+            }
+            state->nbOpeningClaims = 0;
+            return 0;
+        }
+        
+        state->nbOpeningClaims--;
+        memmove(state->openingClaims, state->openingClaims + 1, sizeof(int) * state->nbOpeningClaims);
+    }
+    return 0;
+}
+
+// Ahead with nothing left to finish: longest routes first to end the game
+int raceToEnd(GameState* state, StrategyContext* ctx, MoveData* moveData) {
+    int bestRoute = -1;
+    
+    for (int k = 0; k < ctx->turnAnalysis.nbClaimable; k++) {
+        int i = ctx->turnAnalysis.claimableRoutes[k];
+        if (bestRoute < 0 || state->routes[i].length > state->routes[bestRoute].length) {
+            bestRoute = i;
+        }
+    }
+    
+    if (bestRoute >= 0 && (state->routes[bestRoute].length >= 3 || ctx->turnAnalysis.tempo.turnsRemaining <= 2)) {
+        return claimAnalyzedRoute(state, &ctx->turnAnalysis, bestRoute, moveData);
+    }
+    
+    // Cards for the longest free route still within our wagons
+    int target = -1;
+    for (int i = 0; i < state->nbTracks; i++) {
+        if (state->routes[i].owner == 0 && state->routes[i].length <= state->wagonsLeft &&
+            (target < 0 || state->routes[i].length > state->routes[target].length)) {
+            target = i;
+        }
+    }
+    
+    if (target >= 0) {
+        return drawCardsForRoute(state, state->routes[target].from, state->routes[target].to, moveData);
     }
     
-    return workOnObjectives(state, moveData);
+    moveData->action = DRAW_BLIND_CARD;
+    return 1;
 }
 
-int handleEndgame(GameState* state, MoveData* moveData) {
+int handleEndgame(GameState* state, StrategyContext* ctx, MoveData* moveData) {
     for (int i = 0; i < state->nbObjectives; i++) {
-        if (!isObjectiveCompleted(state, state->objectives[i])) {
+        ObjectiveAnalysis* oa = &ctx->turnAnalysis.objectives[i];
+        if (oa->open) {
             int objFrom = state->objectives[i].from;
             int objTo = state->objectives[i].to;
-            
-            int path[MAX_CITIES];
-            int pathLength = 0;
-            findSmartestPath(state, objFrom, objTo, path, &pathLength);
-            
-            int routesNeeded = 0;
-            for (int j = 0; j < pathLength - 1; j++) {
-                if (getRouteOwner(state, path[j], path[j+1]) == 0) {
-                    routesNeeded++;
-                }
-            }
+            int routesNeeded = segmentsNeeded(state, objFrom, objTo);
             
             if (routesNeeded <= 1 && routesNeeded <= state->wagonsLeft) {
-                for (int j = 0; j < pathLength - 1; j++) {
-                    int cityA = path[j];
-                    int cityB = path[j+1];
+                // The single free route joining the two owned components
+                int compFrom = ownedComponentOf(state, objFrom);
+                int compTo = ownedComponentOf(state, objTo);
+                
+                for (int k = 0; k < ctx->turnAnalysis.nbClaimable; k++) {
+                    int r = ctx->turnAnalysis.claimableRoutes[k];
+                    int a = ownedComponentOf(state, state->routes[r].from);
+                    int b = ownedComponentOf(state, state->routes[r].to);
                     
-                    if (getRouteOwner(state, cityA, cityB) == 0) {
-                        if (canTakeRoute(state, cityA, cityB, moveData)) {
-                            return 1;
-                        }
+                    if ((a == compFrom && b == compTo) || (a == compTo && b == compFrom)) {
+                        return claimAnalyzedRoute(state, &ctx->turnAnalysis, r, moveData);
                     }
                 }
             }
         }
     }
     
-    return takeHighestValueRoute(state, moveData);
+    return takeHighestValueRoute(state, ctx, moveData);
 }
 
-int handleLateGame(GameState* state, MoveData* moveData) {
+int handleLateGame(GameState* state, StrategyContext* ctx, MoveData* moveData) {
     int bestObjective = -1;
     int lowestCost = 999;
     int highestValue = 0;
     
     for (int i = 0; i < state->nbObjectives; i++) {
-        if (!isObjectiveCompleted(state, state->objectives[i])) {
-            int objFrom = state->objectives[i].from;
-            int objTo = state->objectives[i].to;
+        ObjectiveAnalysis* oa = &ctx->turnAnalysis.objectives[i];
+        if (oa->open) {
             int objScore = state->objectives[i].score;
-            
-            int path[MAX_CITIES];
-            int pathLength = 0;
-            findSmartestPath(state, objFrom, objTo, path, &pathLength);
-            
-            int routesNeeded = 0;
-            int wagonsNeeded = 0;
-            
-            for (int j = 0; j < pathLength - 1; j++) {
-                if (getRouteOwner(state, path[j], path[j+1]) == 0) {
-                    routesNeeded++;
-                    wagonsNeeded += 3;
-                }
-            }
+            int wagonsNeeded = oa->nbMissing * 3;
             
             if (wagonsNeeded <= state->wagonsLeft) {
                 float efficiency = (float)objScore / wagonsNeeded;
@@ -352,295 +460,156 @@ int handleLateGame(GameState* state, MoveData* moveData) {
     }
     
     if (bestObjective >= 0) {
-        currentObjectiveIndex = bestObjective;
-        return workOnSingleObjective(state, moveData);
+        ctx->currentObjectiveIndex = bestObjective;
+        return workOnSingleObjective(state, ctx, moveData);
     }
     
-    return buildLongestRoute(state, moveData);
+    return buildLongestRoute(state, ctx, moveData);
 }
 
-int takeHighestValueRoute(GameState* state, MoveData* moveData) {
+int takeHighestValueRoute(GameState* state, StrategyContext* ctx, MoveData* moveData) {
     int bestRoute = -1;
     float bestValue = 0;
     
-    for (int i = 0; i < state->nbTracks; i++) {
-        if (state->routes[i].owner == 0) {
-            int length = state->routes[i].length;
-            if (length <= state->wagonsLeft && canTakeRoute(state, state->routes[i].from, state->routes[i].to, moveData)) {
-                
-                int points = 0;
-                switch (length) {
-                    case 1: points = 1; break;
-                    case 2: points = 2; break;
-                    case 3: points = 4; break;
-                    case 4: points = 7; break;
-                    case 5: points = 10; break;
-                    case 6: points = 15; break;
-                }
-                
-                float value = (float)points / length;
-                
-                if (value > bestValue) {
-                    bestValue = value;
-                    bestRoute = i;
-                }
-            }
+    for (int k = 0; k < ctx->turnAnalysis.nbClaimable; k++) {
+        int i = ctx->turnAnalysis.claimableRoutes[k];
+        int length = state->routes[i].length;
+        
+        float value = (float)routePointsForLength(length) / length;
+        
+        if (value > bestValue) {
+            bestValue = value;
+            bestRoute = i;
         }
     }
     
     if (bestRoute >= 0) {
-        int from = state->routes[bestRoute].from;
-        int to = state->routes[bestRoute].to;
-        return canTakeRoute(state, from, to, moveData);
+        return claimAnalyzedRoute(state, &ctx->turnAnalysis, bestRoute, moveData);
     }
     
     moveData->action = DRAW_BLIND_CARD;
     return 1;
 }
 
-int workOnObjectives(GameState* state, MoveData* moveData) {
-    int totalCards = 0;
-    for (int i = PURPLE; i <= LOCOMOTIVE; i++) {
-        totalCards += state->nbCardsByColor[i];
-    }
-    
-    if (totalCards > 25) {
-        return workOnSingleObjective(state, moveData);
+int workOnObjectives(GameState* state, StrategyContext* ctx, MoveData* moveData) {
+    if (ctx->turnAnalysis.totalCards > 25) {
+        return workOnSingleObjective(state, ctx, moveData);
     }
     
-    return analyzeAllObjectivesAndAct(state, moveData);
+    return analyzeAllObjectivesAndAct(state, ctx, moveData);
 }
 
-int analyzeAllObjectivesAndAct(GameState* state, MoveData* moveData) {
-    int totalCards = 0;
-    for (int i = PURPLE; i <= LOCOMOTIVE; i++) {
-        totalCards += state->nbCardsByColor[i];
-    }
+int analyzeAllObjectivesAndAct(GameState* state, StrategyContext* ctx, MoveData* moveData) {
+    int totalCards = ctx->turnAnalysis.totalCards;
     
     if (totalCards > 40) {
-        return emergencyUnblock(state, moveData);
+        return emergencyUnblock(state, ctx, moveData);
     }
     
-    typedef struct {
-        int index;
-        int from;
-        int to;
-        int score;
-        int path[MAX_CITIES];
-        int pathLength;
-        int routesNeeded;
-        int routesOwned;
-        int blocked;
-    } ObjectiveInfo;
-    
-    ObjectiveInfo objectives[MAX_OBJECTIVES];
+    int objectives[MAX_OBJECTIVES];
     int objectiveCount = 0;
     int blockedObjectives = 0;
     
     for (int i = 0; i < state->nbObjectives; i++) {
-        if (!isObjectiveCompleted(state, state->objectives[i])) {
-            objectives[objectiveCount].index = i;
-            objectives[objectiveCount].from = state->objectives[i].from;
-            objectives[objectiveCount].to = state->objectives[i].to;
-            objectives[objectiveCount].score = state->objectives[i].score;
-            objectives[objectiveCount].blocked = 0;
-            
-            int distance = findSmartestPath(state, objectives[objectiveCount].from, 
-                                          objectives[objectiveCount].to,
-                                          objectives[objectiveCount].path,
-                                          &objectives[objectiveCount].pathLength);
-            
-            if (distance > 0) {
-                int owned = 0, total = objectives[objectiveCount].pathLength - 1;
-                int freeRoutes = 0;
-                
-                for (int j = 0; j < objectives[objectiveCount].pathLength - 1; j++) {
-                    int cityA = objectives[objectiveCount].path[j];
-                    int cityB = objectives[objectiveCount].path[j + 1];
-                    int owner = getRouteOwner(state, cityA, cityB);
-                    
-                    if (owner == 1) {
-                        owned++;
-                    } else if (owner == 0) {
-                        freeRoutes++;
-                    }
-                }
-                
-                objectives[objectiveCount].routesOwned = owned;
-                objectives[objectiveCount].routesNeeded = total - owned;
-                
-                if (freeRoutes == 0 && owned < total) {
-                    objectives[objectiveCount].blocked = 1;
-                    blockedObjectives++;
-                }
-                
-                objectiveCount++;
-            } else {
-                objectives[objectiveCount].blocked = 1;
-                blockedObjectives++;
-                objectiveCount++;
-            }
+        ObjectiveAnalysis* oa = &ctx->turnAnalysis.objectives[i];
+        if (!oa->open) continue;
+        
+        objectives[objectiveCount++] = i;
+        if (oa->blocked) {
+            blockedObjectives++;
         }
     }
     
     if ((blockedObjectives >= objectiveCount && objectiveCount > 0) || totalCards > 30) {
-        return alternativeStrategy(state, moveData, objectives, objectiveCount);
+        return alternativeStrategy(state, ctx, moveData, objectives, objectiveCount);
     }
     
     if (objectiveCount == 0) {
-        return buildLongestRoute(state, moveData);
+        return buildLongestRoute(state, ctx, moveData);
     }
     
-    typedef struct {
-        int from;
-        int to;
-        int usefulForObjectives;
-        int totalObjectiveValue;
-        int routeLength;
-        int priority;
-    } RouteAnalysis;
-    
-    RouteAnalysis routeAnalysis[MAX_ROUTES];
-    int routeAnalysisCount = 0;
-    
-    // Find routes that help multiple objectives
-    for (int r = 0; r < state->nbTracks; r++) {
-        if (state->routes[r].owner == 0) {
-            int routeFrom = state->routes[r].from;
-            int routeTo = state->routes[r].to;
-            int routeLength = state->routes[r].length;
-            
-            int usefulCount = 0;
-            int totalValue = 0;
-            
-            for (int obj = 0; obj < objectiveCount; obj++) {
-                if (!objectives[obj].blocked) {
-                    for (int p = 0; p < objectives[obj].pathLength - 1; p++) {
-                        int pathFrom = objectives[obj].path[p];
-                        int pathTo = objectives[obj].path[p + 1];
-                        
-                        if ((pathFrom == routeFrom && pathTo == routeTo) ||
-                            (pathFrom == routeTo && pathTo == routeFrom)) {
-                            usefulCount++;
-                            totalValue += objectives[obj].score;
-                            break;
-                        }
-                    }
-                }
-            }
-            
-            if (usefulCount > 0) {
-                routeAnalysis[routeAnalysisCount].from = routeFrom;
-                routeAnalysis[routeAnalysisCount].to = routeTo;
-                routeAnalysis[routeAnalysisCount].usefulForObjectives = usefulCount;
-                routeAnalysis[routeAnalysisCount].totalObjectiveValue = totalValue;
-                routeAnalysis[routeAnalysisCount].routeLength = routeLength;
-                
-                routeAnalysis[routeAnalysisCount].priority = totalValue;
-                if (usefulCount > 1) {
-                    routeAnalysis[routeAnalysisCount].priority += usefulCount * 50;
-                }
-                
-                routeAnalysisCount++;
-            }
+    RouteObjectiveIndex* index = &ctx->turnAnalysis.routeIndex;
+    RouteAnalysis top[TOP_ROUTES];
+    int topCount = 0;
+    
+    // Routes used by the plans of several objectives, from the inverted index
+    for (int c = 0; c < index->nbCandidates; c++) {
+        int r = index->candidates[c];
+        int usefulCount = index->routeObjectives[r];
+        
+        RouteAnalysis entry;
+        entry.index = r;
+        entry.priority = index->routeValue[r];
+        if (usefulCount > 1) {
+            entry.priority += usefulCount * 50;
         }
+        entry.priority += (int)(routeUrgency(state, r, 2) * 100);
+        if (routeChokepoint(state, r) == CHOKEPOINT_DISCONNECTS) {
+            entry.priority += 40;
+        }
+        
+        pushTopRoute(top, &topCount, entry);
     }
     
-    // Sort by priority
-    for (int i = 0; i < routeAnalysisCount - 1; i++) {
-        for (int j = 0; j < routeAnalysisCount - i - 1; j++) {
-            if (routeAnalysis[j].priority < routeAnalysis[j+1].priority) {
-                RouteAnalysis temp = routeAnalysis[j];
-                routeAnalysis[j] = routeAnalysis[j+1];
-                routeAnalysis[j+1] = temp;
-            }
-        }
+    int routeAnalysisCount = topCount;
+    RouteAnalysis routeAnalysis[TOP_ROUTES];
+    while (topCount > 0) {
+        routeAnalysis[topCount - 1] = popTopRoute(top, &topCount);
     }
     
     // Try top priority routes
-    for (int i = 0; i < routeAnalysisCount && i < 5; i++) {
-        int from = routeAnalysis[i].from;
-        int to = routeAnalysis[i].to;
-        
-        if (canTakeRoute(state, from, to, moveData)) {
+    for (int i = 0; i < routeAnalysisCount; i++) {
+        if (claimAnalyzedRoute(state, &ctx->turnAnalysis, routeAnalysis[i].index, moveData)) {
             return 1;
         }
     }
     
     if (totalCards > 25) {
-        return alternativeStrategy(state, moveData, objectives, objectiveCount);
+        return alternativeStrategy(state, ctx, moveData, objectives, objectiveCount);
     }
     
     if (routeAnalysisCount > 0) {
-        int from = routeAnalysis[0].from;
-        int to = routeAnalysis[0].to;
+        int from = state->routes[routeAnalysis[0].index].from;
+        int to = state->routes[routeAnalysis[0].index].to;
         return drawCardsForRoute(state, from, to, moveData);
     }
     
-    return workOnSingleObjective(state, moveData);
+    return workOnSingleObjective(state, ctx, moveData);
 }
 
-int emergencyUnblock(GameState* state, MoveData* moveData) {
+int emergencyUnblock(GameState* state, StrategyContext* ctx, MoveData* moveData) {
     // Try long routes first
     for (int length = 6; length >= 5; length--) {
-        for (int i = 0; i < state->nbTracks; i++) {
-            if (state->routes[i].owner == 0 && state->routes[i].length == length) {
-                int from = state->routes[i].from;
-                int to = state->routes[i].to;
-                
-                if (canTakeRoute(state, from, to, moveData)) {
-                    return 1;
-                }
+        for (int k = 0; k < ctx->turnAnalysis.nbClaimable; k++) {
+            int i = ctx->turnAnalysis.claimableRoutes[k];
+            if (state->routes[i].length == length) {
+                return claimAnalyzedRoute(state, &ctx->turnAnalysis, i, moveData);
             }
         }
     }
     
     // Try routes that connect to our network
-    for (int i = 0; i < state->nbTracks; i++) {
-        if (state->routes[i].owner == 0) {
-            int from = state->routes[i].from;
-            int to = state->routes[i].to;
-            
-            int connectsToNetwork = 0;
-            for (int j = 0; j < state->nbClaimedRoutes; j++) {
-                int routeIndex = state->claimedRoutes[j];
-                if (routeIndex >= 0 && routeIndex < state->nbTracks) {
-                    if (state->routes[routeIndex].from == from || state->routes[routeIndex].to == from ||
-                        state->routes[routeIndex].from == to || state->routes[routeIndex].to == to) {
-                        connectsToNetwork = 1;
-                        break;
-                    }
-                }
-            }
-            
-            if (connectsToNetwork && canTakeRoute(state, from, to, moveData)) {
-                return 1;
-            }
+    for (int k = 0; k < ctx->turnAnalysis.nbFrontierRoutes; k++) {
+        if (claimAnalyzedRoute(state, &ctx->turnAnalysis, ctx->turnAnalysis.frontierRoutes[k], moveData)) {
+            return 1;
         }
     }
     
     // Take any route
-    for (int i = 0; i < state->nbTracks; i++) {
-        if (state->routes[i].owner == 0) {
-            int from = state->routes[i].from;
-            int to = state->routes[i].to;
-            
-            if (canTakeRoute(state, from, to, moveData)) {
-                return 1;
-            }
-        }
+    if (ctx->turnAnalysis.nbClaimable > 0) {
+        return claimAnalyzedRoute(state, &ctx->turnAnalysis, ctx->turnAnalysis.claimableRoutes[0], moveData);
     }
     
     moveData->action = DRAW_BLIND_CARD;
     return 1;
 }
 
-int alternativeStrategy(GameState* state, MoveData* moveData, void* objData, int objectiveCount) {
+int alternativeStrategy(GameState* state, StrategyContext* ctx, MoveData* moveData, void* objData, int objectiveCount) {
     (void)objData;
     (void)objectiveCount;
     
     for (int i = 0; i < state->nbObjectives; i++) {
-        if (!isObjectiveCompleted(state, state->objectives[i])) {
+        if (isObjectiveOpen(state, state->objectives[i])) {
             int objFrom = state->objectives[i].from;
             int objTo = state->objectives[i].to;
             
@@ -650,16 +619,14 @@ int alternativeStrategy(GameState* state, MoveData* moveData, void* objData, int
         }
     }
     
-    return buildLongestRoute(state, moveData);
+    return buildLongestRoute(state, ctx, moveData);
 }
 
 int findAlternativePath(GameState* state, int from, int to, MoveData* moveData) {
-    int hubs[] = {5, 10, 15, 20, 25};
-    int numHubs = sizeof(hubs) / sizeof(hubs[0]);
-    
-    for (int h = 0; h < numHubs; h++) {
-        int hub = hubs[h];
-        if (hub >= state->nbCities || hub == from || hub == to) continue;
+    // Detour through the cities most shortest paths go through
+    for (int h = 0; h < state->nbHubs; h++) {
+        int hub = state->hubCities[h];
+        if (hub == from || hub == to) continue;
         
         int path1[MAX_CITIES], path2[MAX_CITIES];
         int pathLength1, pathLength2;
@@ -695,45 +662,19 @@ int findAlternativePath(GameState* state, int from, int to, MoveData* moveData)
     return 0;
 }
 
-int findNearestCompletionObjective(GameState* state) {
+int findNearestCompletionObjective(GameState* state, StrategyContext* ctx) {
     int bestObjective = -1;
     int lowestRoutesNeeded = 999;
     int highestProgress = -1;
     
     for (int i = 0; i < state->nbObjectives; i++) {
-        if (isObjectiveCompleted(state, state->objectives[i])) {
-            continue;
-        }
-        
-        int objFrom = state->objectives[i].from;
-        int objTo = state->objectives[i].to;
+        ObjectiveAnalysis* oa = &ctx->turnAnalysis.objectives[i];
         
-        int path[MAX_CITIES];
-        int pathLength = 0;
-        int distance = findSmartestPath(state, objFrom, objTo, path, &pathLength);
-        
-        if (distance <= 0) continue;
-        
-        int routesOwned = 0;
-        int routesAvailable = 0;
-        int routesBlocked = 0;
-        int totalRoutes = pathLength - 1;
-        
-        for (int j = 0; j < pathLength - 1; j++) {
-            int cityA = path[j];
-            int cityB = path[j + 1];
-            int owner = getRouteOwner(state, cityA, cityB);
-            
-            if (owner == 1) {
-                routesOwned++;
-            } else if (owner == 0) {
-                routesAvailable++;
-            } else {
-                routesBlocked++;
-            }
-        }
+        if (!oa->open || oa->distance <= 0) continue;
         
-        int routesNeeded = routesAvailable;
+        int routesOwned = oa->routesOwned;
+        int routesBlocked = oa->routesBlocked;
+        int routesNeeded = oa->nbMissing;
         
         // Priority for 1-route objectives
         if (routesNeeded == 1 && routesBlocked == 0) {
@@ -759,50 +700,50 @@ int findNearestCompletionObjective(GameState* state) {
     return bestObjective;
 }
 
-int workOnSingleObjective(GameState* state, MoveData* moveData) {
-    int bestObjective = findNearestCompletionObjective(state);
+int workOnSingleObjective(GameState* state, StrategyContext* ctx, MoveData* moveData) {
+    int bestObjective = findNearestCompletionObjective(state, ctx);
     
     if (bestObjective < 0) {
-        return buildLongestRoute(state, moveData);
+        return buildLongestRoute(state, ctx, moveData);
     }
     
-    currentObjectiveIndex = bestObjective;
+    ctx->currentObjectiveIndex = bestObjective;
     
-    if (isObjectiveCompleted(state, state->objectives[currentObjectiveIndex])) {
-        currentObjectiveIndex = -1;
-        return workOnSingleObjective(state, moveData);
-    }
+    ObjectiveAnalysis* oa = &ctx->turnAnalysis.objectives[ctx->currentObjectiveIndex];
     
-    int objFrom = state->objectives[currentObjectiveIndex].from;
-    int objTo = state->objectives[currentObjectiveIndex].to;
+    if (!oa->open || oa->distance <= 0) {
+        ctx->currentObjectiveIndex = -1;
+        return buildLongestRoute(state, ctx, moveData);
+    }
     
-    int distance = findSmartestPath(state, objFrom, objTo, currentPath, &currentPathLength);
+    // The route we can build soonest, given our hand and the contention
+    HandCostContext handCost;
+    prepareHandCost(state, &handCost);
+    EdgeCostKernel kernel = {handAwareEdgeCost, &handCost};
     
-    if (distance <= 0) {
-        currentObjectiveIndex = -1;
-        return workOnSingleObjective(state, moveData);
+    int objFrom = state->objectives[ctx->currentObjectiveIndex].from;
+    int objTo = state->objectives[ctx->currentObjectiveIndex].to;
+    if (findPathWithKernel(state, objFrom, objTo, ctx->currentPath, &ctx->currentPathLength, &kernel) < 0) {
+        ctx->currentPathLength = oa->pathLength;
+        memcpy(ctx->currentPath, oa->path, sizeof(int) * oa->pathLength);
     }
     
-    for (int i = 0; i < currentPathLength - 1; i++) {
-        int cityA = currentPath[i];
-        int cityB = currentPath[i + 1];
-        
-        int routeOwner = getRouteOwner(state, cityA, cityB);
-        
-        if (routeOwner == 0) {
-            if (canTakeRoute(state, cityA, cityB, moveData)) {
-                return 1;
-            } else {
-                return drawCardsForRouteAggressively(state, cityA, cityB, moveData);
-            }
-        } else if (routeOwner == 1) {
-            continue;
-        } else {
-            return workOnSingleObjective(state, moveData);
+    // Claim the scarce, at-risk segments first
+    int order[MAX_CITIES];
+    int missing = scheduleClaims(state, ctx->currentPath, ctx->currentPathLength, order);
+    
+    for (int i = 0; i < missing; i++) {
+        if (claimAnalyzedRoute(state, &ctx->turnAnalysis, order[i], moveData)) {
+            return 1;
         }
     }
     
-    return workOnSingleObjective(state, moveData);
+    if (missing > 0) {
+        return drawCardsForRouteAggressively(state, state->routes[order[0]].from,
+                                             state->routes[order[0]].to, moveData);
+    }
+    
+    return buildLongestRoute(state, ctx, moveData);
 }
 
 int drawCardsForRouteAggressively(GameState* state, int from, int to, MoveData* moveData) {
@@ -873,80 +814,38 @@ int drawCardsForRouteAggressively(GameState* state, int from, int to, MoveData*
     return 1;
 }
 
-int buildLongestRoute(GameState* state, MoveData* moveData) {
-    int totalCards = 0;
-    for (int i = PURPLE; i <= LOCOMOTIVE; i++) {
-        totalCards += state->nbCardsByColor[i];
-    }
-    
-    if (totalCards > 15 && state->nbObjectives < 5) {
+int buildLongestRoute(GameState* state, StrategyContext* ctx, MoveData* moveData) {
+    if (ctx->turnAnalysis.totalCards > 15 && estimateObjectiveDrawValue(state) > 0) {
         moveData->action = DRAW_OBJECTIVES;
         return 1;
     }
     
-    int networkCities[MAX_CITIES];
-    int networkCityCount = 0;
-    
-    // Build list of our network cities
-    for (int i = 0; i < state->nbClaimedRoutes; i++) {
-        int routeIndex = state->claimedRoutes[i];
-        if (routeIndex >= 0 && routeIndex < state->nbTracks) {
-            int from = state->routes[routeIndex].from;
-            int to = state->routes[routeIndex].to;
-            
-            int fromFound = 0, toFound = 0;
-            for (int j = 0; j < networkCityCount; j++) {
-                if (networkCities[j] == from) fromFound = 1;
-                if (networkCities[j] == to) toFound = 1;
-            }
-            if (!fromFound && networkCityCount < MAX_CITIES) {
-                networkCities[networkCityCount++] = from;
-            }
-            if (!toFound && networkCityCount < MAX_CITIES) {
-                networkCities[networkCityCount++] = to;
-            }
-        }
-    }
-    
     int bestRouteIndex = -1;
     int bestScore = 0;
     
     // Find best route that connects to our network
-    for (int i = 0; i < state->nbTracks; i++) {
-        if (state->routes[i].owner == 0) {
-            int from = state->routes[i].from;
-            int to = state->routes[i].to;
-            int length = state->routes[i].length;
-            
-            int connectsToNetwork = 0;
-            for (int j = 0; j < networkCityCount; j++) {
-                if (networkCities[j] == from || networkCities[j] == to) {
-                    connectsToNetwork = 1;
-                    break;
-                }
-            }
+    for (int k = 0; k < ctx->turnAnalysis.nbFrontierRoutes; k++) {
+        int i = ctx->turnAnalysis.frontierRoutes[k];
+        int length = state->routes[i].length;
+        
+        if (ctx->turnAnalysis.claimable[i]) {
+            int score = length * 10;
+            if (length >= 5) score += 100;
+            if (length >= 4) score += 50;
+            if (length >= 3) score += 25;
             
-            if (connectsToNetwork && canTakeRoute(state, from, to, moveData)) {
-                int score = length * 10;
-                if (length >= 5) score += 100;
-                if (length >= 4) score += 50;
-                if (length >= 3) score += 25;
-                
-                if (score > bestScore) {
-                    bestScore = score;
-                    bestRouteIndex = i;
-                }
+            if (score > bestScore) {
+                bestScore = score;
+                bestRouteIndex = i;
             }
         }
     }
     
     if (bestRouteIndex >= 0) {
-        int from = state->routes[bestRouteIndex].from;
-        int to = state->routes[bestRouteIndex].to;
-        return canTakeRoute(state, from, to, moveData);
+        return claimAnalyzedRoute(state, &ctx->turnAnalysis, bestRouteIndex, moveData);
     }
     
-    return takeAnyGoodRoute(state, moveData);
+    return takeAnyGoodRoute(state, ctx, moveData);
 }
 
 int getRouteOwner(GameState* state, int from, int to) {
@@ -973,6 +872,16 @@ int canTakeRoute(GameState* state, int from, int to, MoveData* moveData) {
     
     if (routeIndex < 0) return 0;
     
+    return canTakeRouteIndex(state, routeIndex, moveData);
+}
+
+int canTakeRouteIndex(GameState* state, int routeIndex, MoveData* moveData) {
+    if (routeIndex < 0 || routeIndex >= state->nbTracks || state->routes[routeIndex].owner != 0) {
+        return 0;
+    }
+    
+    int from = state->routes[routeIndex].from;
+    int to = state->routes[routeIndex].to;
     int length = state->routes[routeIndex].length;
     CardColor routeColor = state->routes[routeIndex].color;
     
@@ -1098,63 +1007,93 @@ int drawCardsForRoute(GameState* state, int from, int to, MoveData* moveData) {
     return 1;
 }
 
-int takeAnyGoodRoute(GameState* state, MoveData* moveData) {
+int takeAnyGoodRoute(GameState* state, StrategyContext* ctx, MoveData* moveData) {
     int bestLength = 0;
-    int bestFrom = -1, bestTo = -1;
+    int bestRoute = -1;
     
-    for (int i = 0; i < state->nbTracks; i++) {
-        if (state->routes[i].owner == 0) {
-            int from = state->routes[i].from;
-            int to = state->routes[i].to;
-            int length = state->routes[i].length;
-            
-            if (length > bestLength && canTakeRoute(state, from, to, moveData)) {
-                bestLength = length;
-                bestFrom = from;
-                bestTo = to;
-            }
+    for (int k = 0; k < ctx->turnAnalysis.nbClaimable; k++) {
+        int i = ctx->turnAnalysis.claimableRoutes[k];
+        int length = state->routes[i].length;
+        
+        if (length > bestLength) {
+            bestLength = length;
+            bestRoute = i;
         }
     }
     
-    if (bestFrom >= 0) {
-        return canTakeRoute(state, bestFrom, bestTo, moveData);
+    if (bestRoute >= 0) {
+        return claimAnalyzedRoute(state, &ctx->turnAnalysis, bestRoute, moveData);
     }
     
     moveData->action = DRAW_BLIND_CARD;
     return 1;
 }
 
-int decideNextMove(GameState* state, MoveData* moveData) {
-    if (!state || !moveData) {
+void initStrategyContext(StrategyContext* ctx) {
+    memset(ctx, 0, sizeof(StrategyContext));
+    ctx->currentObjectiveIndex = -1;
+}
+
+int decideNextMove(GameState* state, StrategyContext* ctx, MoveData* moveData) {
+    if (!state || !ctx || !moveData) {
         return 0;
     }
     
-    return simpleStrategy(state, moveData);
+    state->turnCount++;
+    
+    // Paths, claimable routes and network computed once for the whole cascade
+    computeTurnAnalysis(state, &ctx->turnAnalysis);
+    
+    return simpleStrategy(state, ctx, moveData);
+}
+
+// Second card of a draw: first visible non-locomotive, blind otherwise
+void chooseSecondCard(GameState* state, MoveData* moveData) {
+    for (int i = 0; i < 5; i++) {
+        if (state->visibleCards[i] != LOCOMOTIVE && state->visibleCards[i] != NONE) {
+            moveData->action = DRAW_CARD;
+            moveData->drawCard = state->visibleCards[i];
+            return;
+        }
+    }
+    
+    moveData->action = DRAW_BLIND_CARD;
 }
 
 void chooseObjectivesStrategy(GameState* state, Objective* objectives, unsigned char* chooseObjectives) {
+    // Opening deals solved offline, live analysis for anything the book misses
+    if (state->nbObjectives == 0 && state->nbClaimedRoutes == 0 &&
+        lookupOpening(state, objectives, chooseObjectives)) {
+        return;
+    }
+    
+    // Whole keep-set against our wagon budget, per-ticket heuristic as fallback
+    if (choosePortfolio(state, objectives, 3, chooseObjectives)) {
+        return;
+    }
+    
     simpleChooseObjectives(state, objectives, chooseObjectives);
 }
 
-int isAntiAdversaireMode(GameState* state) {
-    int adversaireProcheFin = (state->opponentWagonsLeft <= 5);
+int isAntiAdversaireMode(GameState* state, StrategyContext* ctx) {
+    int adversaireProcheFin = (ctx->turnAnalysis.tempo.opponentTurns <= 2);
     int tropDeCartes = (state->nbCards > 15);
     int dernierTour = state->lastTurn;
     
     return (adversaireProcheFin && tropDeCartes) || dernierTour;
 }
 
-int handleAntiAdversaire(GameState* state, MoveData* moveData) {
-    int quickObjective = findQuickestObjective(state);
+int handleAntiAdversaire(GameState* state, StrategyContext* ctx, MoveData* moveData) {
+    int quickObjective = findQuickestObjective(state, ctx);
     if (quickObjective >= 0) {
-        return workOnSpecificObjective(state, moveData, quickObjective);
+        return workOnSpecificObjective(state, ctx, moveData, quickObjective);
     }
     
-    if (buildFromExistingNetwork(state, moveData)) {
+    if (buildFromExistingNetwork(state, ctx, moveData)) {
         return 1;
     }
     
-    if (takeAnyProfitableRoute(state, moveData)) {
+    if (takeAnyProfitableRoute(state, ctx, moveData)) {
         return 1;
     }
     
@@ -1162,30 +1101,20 @@ int handleAntiAdversaire(GameState* state, MoveData* moveData) {
     return 1;
 }
 
-int findQuickestObjective(GameState* state) {
+int findQuickestObjective(GameState* state, StrategyContext* ctx) {
     int bestObjective = -1;
     int lowestCost = 999;
     
     for (int i = 0; i < state->nbObjectives; i++) {
-        if (isObjectiveCompleted(state, state->objectives[i])) {
+        ObjectiveAnalysis* oa = &ctx->turnAnalysis.objectives[i];
+        
+        if (!oa->open) {
             continue;
         }
         
-        int objFrom = state->objectives[i].from;
-        int objTo = state->objectives[i].to;
-        
-        int path[MAX_CITIES];
-        int pathLength = 0;
-        int distance = findSmartestPath(state, objFrom, objTo, path, &pathLength);
-        
-        if (distance > 0) {
-            int wagonsNeeded = 0;
-            
-            for (int j = 0; j < pathLength - 1; j++) {
-                if (getRouteOwner(state, path[j], path[j+1]) == 0) {
-                    wagonsNeeded += 2;
-                }
-            }
+        int routesNeeded = segmentsNeeded(state, state->objectives[i].from, state->objectives[i].to);
+        if (routesNeeded > 0 && routesNeeded != SEGMENTS_UNREACHABLE) {
+            int wagonsNeeded = routesNeeded * 2;
             
             if (wagonsNeeded <= state->wagonsLeft && wagonsNeeded < lowestCost) {
                 lowestCost = wagonsNeeded;
@@ -1197,113 +1126,62 @@ int findQuickestObjective(GameState* state) {
     return bestObjective;
 }
 
-int buildFromExistingNetwork(GameState* state, MoveData* moveData) {
-    int networkCities[MAX_CITIES];
-    int networkCityCount = 0;
-    
-    for (int i = 0; i < state->nbClaimedRoutes; i++) {
-        int routeIndex = state->claimedRoutes[i];
-        if (routeIndex >= 0 && routeIndex < state->nbTracks) {
-            int from = state->routes[routeIndex].from;
-            int to = state->routes[routeIndex].to;
-            
-            int fromFound = 0, toFound = 0;
-            for (int j = 0; j < networkCityCount; j++) {
-                if (networkCities[j] == from) fromFound = 1;
-                if (networkCities[j] == to) toFound = 1;
-            }
-            if (!fromFound && networkCityCount < MAX_CITIES) {
-                networkCities[networkCityCount++] = from;
-            }
-            if (!toFound && networkCityCount < MAX_CITIES) {
-                networkCities[networkCityCount++] = to;
-            }
-        }
-    }
-    
+int buildFromExistingNetwork(GameState* state, StrategyContext* ctx, MoveData* moveData) {
     int bestRoute = -1;
     int bestValue = 0;
     
-    for (int i = 0; i < state->nbTracks; i++) {
-        if (state->routes[i].owner == 0) {
-            int from = state->routes[i].from;
-            int to = state->routes[i].to;
-            int length = state->routes[i].length;
-            
-            int connectsToNetwork = 0;
-            for (int j = 0; j < networkCityCount; j++) {
-                if (networkCities[j] == from || networkCities[j] == to) {
-                    connectsToNetwork = 1;
-                    break;
-                }
-            }
+    for (int k = 0; k < ctx->turnAnalysis.nbFrontierRoutes; k++) {
+        int i = ctx->turnAnalysis.frontierRoutes[k];
+        int length = state->routes[i].length;
+        
+        if (ctx->turnAnalysis.claimable[i]) {
+            int value = length * 10;
+            if (length >= 5) value += 50;
             
-            if (connectsToNetwork && canTakeRoute(state, from, to, moveData)) {
-                int value = length * 10;
-                if (length >= 5) value += 50;
-                
-                if (value > bestValue) {
-                    bestValue = value;
-                    bestRoute = i;
-                }
+            if (value > bestValue) {
+                bestValue = value;
+                bestRoute = i;
             }
         }
     }
     
     if (bestRoute >= 0) {
-        int from = state->routes[bestRoute].from;
-        int to = state->routes[bestRoute].to;
-        return canTakeRoute(state, from, to, moveData);
+        return claimAnalyzedRoute(state, &ctx->turnAnalysis, bestRoute, moveData);
     }
     
     return 0;
 }
 
-int takeAnyProfitableRoute(GameState* state, MoveData* moveData) {
+int takeAnyProfitableRoute(GameState* state, StrategyContext* ctx, MoveData* moveData) {
     int bestRoute = -1;
     int bestValue = 0;
     
-    for (int i = 0; i < state->nbTracks; i++) {
-        if (state->routes[i].owner == 0) {
-            int from = state->routes[i].from;
-            int to = state->routes[i].to;
-            int length = state->routes[i].length;
-            
-            if (length >= 4 && canTakeRoute(state, from, to, moveData)) {
-                int value = length;
-                if (value > bestValue) {
-                    bestValue = value;
-                    bestRoute = i;
-                }
+    for (int k = 0; k < ctx->turnAnalysis.nbClaimable; k++) {
+        int i = ctx->turnAnalysis.claimableRoutes[k];
+        int length = state->routes[i].length;
+        
+        if (length >= 4) {
+            int value = length;
+            if (value > bestValue) {
+                bestValue = value;
+                bestRoute = i;
             }
         }
     }
     
     if (bestRoute >= 0) {
-        int from = state->routes[bestRoute].from;
-        int to = state->routes[bestRoute].to;
-        return canTakeRoute(state, from, to, moveData);
+        return claimAnalyzedRoute(state, &ctx->turnAnalysis, bestRoute, moveData);
     }
     
     return 0;
 }
 
-int workOnSpecificObjective(GameState* state, MoveData* moveData, int objectiveIndex) {
-    int objFrom = state->objectives[objectiveIndex].from;
-    int objTo = state->objectives[objectiveIndex].to;
+int workOnSpecificObjective(GameState* state, StrategyContext* ctx, MoveData* moveData, int objectiveIndex) {
+    ObjectiveAnalysis* oa = &ctx->turnAnalysis.objectives[objectiveIndex];
     
-    int path[MAX_CITIES];
-    int pathLength = 0;
-    findSmartestPath(state, objFrom, objTo, path, &pathLength);
-    
-    for (int i = 0; i < pathLength - 1; i++) {
-        int cityA = path[i];
-        int cityB = path[i + 1];
-        
-        if (getRouteOwner(state, cityA, cityB) == 0) {
-            if (canTakeRoute(state, cityA, cityB, moveData)) {
-                return 1;
-            }
+    for (int i = 0; i < oa->nbMissing; i++) {
+        if (claimAnalyzedRoute(state, &ctx->turnAnalysis, oa->missingRoutes[i], moveData)) {
+            return 1;
         }
     }
     
@@ -1,25 +1,39 @@
 #ifndef STRATEGY_H
 #define STRATEGY_H
 #include "gamestate.h"
+#include "analysis.h"
 #include "../tickettorideapi/ticketToRide.h"
 
-int simpleStrategy(GameState* state, MoveData* moveData);
-int decideNextMove(GameState* state, MoveData* moveData);
+// Plan and per-turn analysis of one game, owned by the caller
+typedef struct {
+    int currentObjectiveIndex;
+    int currentPath[MAX_CITIES];
+    int currentPathLength;
+    TurnAnalysis turnAnalysis;
+} StrategyContext;
+
+void initStrategyContext(StrategyContext* ctx);
+
+int simpleStrategy(GameState* state, StrategyContext* ctx, MoveData* moveData);
+int decideNextMove(GameState* state, StrategyContext* ctx, MoveData* moveData);
 int findBestObjective(GameState* state);
 int canTakeRoute(GameState* state, int from, int to, MoveData* moveData);
+int canTakeRouteIndex(GameState* state, int routeIndex, MoveData* moveData);
+int findSmartestPath(GameState* state, int start, int end, int* path, int* pathLength);
 int drawCardsForRoute(GameState* state, int from, int to, MoveData* moveData);
 int drawBestCard(GameState* state, MoveData* moveData);
 void simpleChooseObjectives(GameState* state, Objective* objectives, unsigned char* chooseObjectives);
 void chooseObjectivesStrategy(GameState* state, Objective* objectives, unsigned char* chooseObjectives);
-int emergencyUnblock(GameState* state, MoveData* moveData);
-int alternativeStrategy(GameState* state, MoveData* moveData, void* objData, int objectiveCount);
+void chooseSecondCard(GameState* state, MoveData* moveData);
+int emergencyUnblock(GameState* state, StrategyContext* ctx, MoveData* moveData);
+int alternativeStrategy(GameState* state, StrategyContext* ctx, MoveData* moveData, void* objData, int objectiveCount);
 int findAlternativePath(GameState* state, int from, int to, MoveData* moveData);
 int drawCardsForRouteAggressively(GameState* state, int from, int to, MoveData* moveData);
-int isAntiAdversaireMode(GameState* state);
-int handleAntiAdversaire(GameState* state, MoveData* moveData);
-int findQuickestObjective(GameState* state);
-int buildFromExistingNetwork(GameState* state, MoveData* moveData);
-int takeAnyProfitableRoute(GameState* state, MoveData* moveData);
-int workOnSpecificObjective(GameState* state, MoveData* moveData, int objectiveIndex);
+int isAntiAdversaireMode(GameState* state, StrategyContext* ctx);
+int handleAntiAdversaire(GameState* state, StrategyContext* ctx, MoveData* moveData);
+int findQuickestObjective(GameState* state, StrategyContext* ctx);
+int buildFromExistingNetwork(GameState* state, StrategyContext* ctx, MoveData* moveData);
+int takeAnyProfitableRoute(GameState* state, StrategyContext* ctx, MoveData* moveData);
+int workOnSpecificObjective(GameState* state, StrategyContext* ctx, MoveData* moveData, int objectiveIndex);
 
 #endif
\ No newline at end of file
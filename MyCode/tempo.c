@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "tempo.h"
+#include "rules.h"
+#include "reachability.h"
+#include "segments.h"
+
+#define START_WAGONS 45
+#define PRIOR_BURN_RATE 1.5f   // wagons per turn before anything is observed
+#define PRIOR_WEIGHT 4         // turns worth of prior
+#define CLAIM_WAGONS 3.5f      // average route bought from a hand
+#define OPPONENT_TICKET_GUESS 5
+#define RACE_MARGIN 10
+#define STALL_HORIZON 10
+
+static float burnRate(int wagonsLeft, int turns) {
+    int spent = START_WAGONS - wagonsLeft;
+    if (spent < 0) spent = 0;
+    return (spent + PRIOR_BURN_RATE * PRIOR_WEIGHT) / (turns + PRIOR_WEIGHT);
+}
+
+// Cards in hand turn into claims right away, the rest at the observed rate
+static int turnsToEnd(int wagonsLeft, int handSize, float rate) {
+    int needed = wagonsLeft - 2;
+    if (needed <= 0) return 0;
+    
+    int fromHand = handSize < needed ? handSize : needed;
+    float turns = fromHand / CLAIM_WAGONS;
+    if (rate < 0.5f) rate = 0.5f;
+    turns += (needed - fromHand) / rate;
+    
+    return (int)(turns + 0.5f);
+}
+
+static int routePoints(GameState* state, int owner) {
+    int points = 0;
+    for (int r = 0; r < state->nbTracks; r++) {
+        if (state->routes[r].owner == owner) {
+            points += routePointsForLength(state->routes[r].length);
+        }
+    }
+    return points;
+}
+
+// Open tickets count as likely kept if their missing routes fit the time left
+static int projectOurScore(GameState* state, int turnsRemaining) {
+    int score = routePoints(state, 1);
+    
+    for (int i = 0; i < state->nbObjectives; i++) {
+        Objective objective = state->objectives[i];
+        int value = (int)objective.score;
+        
+        if (isObjectiveCompleted(state, objective)) {
+            score += value;
+            continue;
+        }
+        
+        int missing = isObjectiveOpen(state, objective) ? segmentsNeeded(state, objective.from, objective.to)
+                                                        : SEGMENTS_UNREACHABLE;
+        if (missing != SEGMENTS_UNREACHABLE && missing * 2 <= turnsRemaining) {
+            score += (value * 4) / 10;
+        } else {
+            score -= value;
+        }
+    }
+    
+    return score;
+}
+
+void computeTempo(GameState* state, TempoModel* tempo) {
+    int turns = state->turnCount;
+    
+    tempo->ourBurnRate = burnRate(state->wagonsLeft, turns);
+    tempo->opponentBurnRate = burnRate(state->opponentWagonsLeft, turns);
+    tempo->ourTurns = turnsToEnd(state->wagonsLeft, state->nbCards, tempo->ourBurnRate);
+    tempo->opponentTurns = turnsToEnd(state->opponentWagonsLeft, state->opponentCardCount,
+                                      tempo->opponentBurnRate);
+    
+    // Whoever gets to 2 wagons first triggers one final round
+    int untilTrigger = tempo->ourTurns < tempo->opponentTurns ? tempo->ourTurns : tempo->opponentTurns;
+    tempo->turnsRemaining = state->lastTurn ? 1 : untilTrigger + 1;
+    
+    tempo->projectedScore = projectOurScore(state, tempo->turnsRemaining);
+    tempo->projectedOpponentScore = routePoints(state, 2) + state->opponentObjectiveCount * OPPONENT_TICKET_GUESS;
+    
+    int lead = tempo->projectedScore - tempo->projectedOpponentScore;
+    
+    // Racing only pays once nothing open can still be finished in time
+    int objectivesPending = 0;
+    for (int i = 0; i < state->nbObjectives; i++) {
+        Objective objective = state->objectives[i];
+        if (!isObjectiveOpen(state, objective)) continue;
+        
+        int missing = segmentsNeeded(state, objective.from, objective.to);
+        if (missing != SEGMENTS_UNREACHABLE && missing * 2 <= tempo->turnsRemaining) {
+            objectivesPending = 1;
+            break;
+        }
+    }
+    
+    tempo->mode = TEMPO_NORMAL;
+    if (lead >= RACE_MARGIN && !objectivesPending && state->nbObjectives > 0) {
+        tempo->mode = TEMPO_RACE;
+    } else if (lead < 0 && tempo->turnsRemaining <= STALL_HORIZON) {
+        tempo->mode = TEMPO_STALL;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+#ifndef TEMPO_H
+#define TEMPO_H
+#include "gamestate.h"
+#include "../tickettorideapi/ticketToRide.h"
+
+#define TEMPO_NORMAL 0
+#define TEMPO_RACE 1   // ahead: burn wagons on long routes to end the game
+#define TEMPO_STALL 2  // behind: do not bring the end closer
+
+typedef struct {
+    float ourBurnRate;        // wagons per turn
+    float opponentBurnRate;
+    int ourTurns;             // turns until each player is down to 2 wagons
+    int opponentTurns;
+    int turnsRemaining;       // our turns left, final round included
+    int projectedScore;
+    int projectedOpponentScore;
+    int mode;
+} TempoModel;
+
+void computeTempo(GameState* state, TempoModel* tempo);
+
+#endif
\ No newline at end of file
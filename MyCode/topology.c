@@ -0,0 +1,321 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "topology.h"
+
+#define REMOTE_REGION_FACTOR 1.15f
+#define REGION_ITERATIONS 5
+
+typedef struct {
+    int dist;
+    int city;
+} HeapItem;
+
+// Binary min-heap on distance; stale entries are skipped when popped
+static void pushItem(HeapItem* heap, int* size, int dist, int city) {
+    int i = (*size)++;
+    while (i > 0 && heap[(i - 1) / 2].dist > dist) {
+        heap[i] = heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap[i].dist = dist;
+    heap[i].city = city;
+}
+
+static HeapItem popItem(HeapItem* heap, int* size) {
+    HeapItem top = heap[0];
+    HeapItem last = heap[--(*size)];
+    int i = 0;
+    
+    while (2 * i + 1 < *size) {
+        int child = 2 * i + 1;
+        if (child + 1 < *size && heap[child + 1].dist < heap[child].dist) child++;
+        if (heap[child].dist >= last.dist) break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = last;
+    return top;
+}
+
+static int hasPredecessor(const int* preds, int count, int city) {
+    for (int k = 0; k < count; k++) {
+        if (preds[k] == city) return 1;
+    }
+    return 0;
+}
+
+// Brandes: one weighted Dijkstra per source over the incidence lists, dependencies
+// accumulated in reverse. A city's predecessors are among its neighbours, so they
+// live in its own slice of incidentRoutes' index range.
+static void computeBetweenness(GameState* state) {
+    int n = state->nbCities;
+    
+    for (int c = 0; c < MAX_CITIES; c++) {
+        state->cityBetweenness[c] = 0;
+    }
+    
+    for (int s = 0; s < n; s++) {
+        int dist[MAX_CITIES];
+        double sigma[MAX_CITIES];
+        double delta[MAX_CITIES];
+        int visited[MAX_CITIES] = {0};
+        int order[MAX_CITIES];
+        int nbOrdered = 0;
+        int preds[MAX_ROUTES * 2];
+        int nbPreds[MAX_CITIES];
+        HeapItem heap[MAX_ROUTES * 2 + 1];
+        int heapSize = 0;
+        
+        for (int v = 0; v < n; v++) {
+            dist[v] = INT_MAX;
+            sigma[v] = 0;
+            delta[v] = 0;
+            nbPreds[v] = 0;
+        }
+        dist[s] = 0;
+        sigma[s] = 1;
+        pushItem(heap, &heapSize, 0, s);
+        
+        while (heapSize > 0) {
+            HeapItem item = popItem(heap, &heapSize);
+            int u = item.city;
+            if (visited[u] || item.dist != dist[u]) continue;
+            
+            visited[u] = 1;
+            state->cityDistance[s][u] = dist[u];
+            order[nbOrdered++] = u;
+            
+            for (int k = state->incidentStart[u]; k < state->incidentStart[u + 1]; k++) {
+                Route* route = &state->routes[state->incidentRoutes[k]];
+                int v = route->from == u ? route->to : route->from;
+                if (visited[v]) continue;
+                
+                int* vPreds = &preds[state->incidentStart[v]];
+                int alt = dist[u] + route->length;
+                if (alt < dist[v]) {
+                    dist[v] = alt;
+                    sigma[v] = sigma[u];
+                    vPreds[0] = u;
+                    nbPreds[v] = 1;
+                    pushItem(heap, &heapSize, alt, v);
+                } else if (alt == dist[v] && !hasPredecessor(vPreds, nbPreds[v], u)) {
+                    // A parallel track is the same city pair, not one more shortest path
+                    sigma[v] += sigma[u];
+                    vPreds[nbPreds[v]++] = u;
+                }
+            }
+        }
+        
+        for (int v = 0; v < n; v++) {
+            if (!visited[v]) {
+                state->cityDistance[s][v] = -1;
+            }
+        }
+        
+        for (int k = nbOrdered - 1; k > 0; k--) {
+            int w = order[k];
+            int* wPreds = &preds[state->incidentStart[w]];
+            for (int p = 0; p < nbPreds[w]; p++) {
+                int v = wPreds[p];
+                delta[v] += sigma[v] / sigma[w] * (1.0 + delta[w]);
+            }
+            state->cityBetweenness[w] += (float)delta[w];
+        }
+    }
+    
+    // Undirected graph: every pair was counted from both ends
+    for (int c = 0; c < n; c++) {
+        state->cityBetweenness[c] /= 2;
+    }
+}
+
+// Mean distance to every reachable city: the cost of tying it into a network
+static void computeConnectionCosts(GameState* state) {
+    int n = state->nbCities;
+    float total = 0;
+    int counted = 0;
+    
+    for (int c = 0; c < n; c++) {
+        int sum = 0;
+        int reachable = 0;
+        
+        for (int o = 0; o < n; o++) {
+            if (o != c && state->cityDistance[c][o] > 0) {
+                sum += state->cityDistance[c][o];
+                reachable++;
+            }
+        }
+        
+        state->cityConnectionCost[c] = reachable > 0 ? (float)sum / reachable : 0;
+        if (reachable > 0) {
+            total += state->cityConnectionCost[c];
+            counted++;
+        }
+    }
+    
+    state->mapConnectionCost = counted > 0 ? total / counted : 0;
+}
+
+static int regionDistance(GameState* state, int a, int b) {
+    int d = state->cityDistance[a][b];
+    return d < 0 ? INT_MAX / 4 : d;
+}
+
+// k-medoids seeded by farthest points from the most central city
+static void computeRegions(GameState* state) {
+    int n = state->nbCities;
+    int k = n / 8;
+    if (k < 2) k = 2;
+    if (k > MAX_REGIONS) k = MAX_REGIONS;
+    if (k > n) k = n;
+    
+    int medoids[MAX_REGIONS];
+    int center = 0;
+    for (int c = 1; c < n; c++) {
+        if (state->cityConnectionCost[c] < state->cityConnectionCost[center]) {
+            center = c;
+        }
+    }
+    medoids[0] = center;
+    
+    for (int m = 1; m < k; m++) {
+        int farthest = -1;
+        int farthestDist = -1;
+        
+        for (int c = 0; c < n; c++) {
+            int nearest = INT_MAX;
+            for (int j = 0; j < m; j++) {
+                int d = regionDistance(state, c, medoids[j]);
+                if (d < nearest) nearest = d;
+            }
+            if (nearest > farthestDist) {
+                farthestDist = nearest;
+                farthest = c;
+            }
+        }
+        medoids[m] = farthest;
+    }
+    
+    for (int it = 0; it < REGION_ITERATIONS; it++) {
+        for (int c = 0; c < n; c++) {
+            int best = 0;
+            for (int m = 1; m < k; m++) {
+                if (regionDistance(state, c, medoids[m]) < regionDistance(state, c, medoids[best])) {
+                    best = m;
+                }
+            }
+            state->cityRegion[c] = best;
+        }
+        
+        int changed = 0;
+        for (int m = 0; m < k; m++) {
+            int bestMedoid = medoids[m];
+            long bestSum = LONG_MAX;
+            
+            for (int c = 0; c < n; c++) {
+                if (state->cityRegion[c] != m) continue;
+                
+                long sum = 0;
+                for (int o = 0; o < n; o++) {
+                    if (state->cityRegion[o] == m) {
+                        sum += regionDistance(state, c, o);
+                    }
+                }
+                if (sum < bestSum) {
+                    bestSum = sum;
+                    bestMedoid = c;
+                }
+            }
+            
+            if (bestMedoid != medoids[m]) {
+                medoids[m] = bestMedoid;
+                changed = 1;
+            }
+        }
+        
+        if (!changed) break;
+    }
+    
+    state->nbRegions = k;
+    for (int m = 0; m < k; m++) {
+        float sum = 0;
+        int members = 0;
+        for (int c = 0; c < n; c++) {
+            if (state->cityRegion[c] == m) {
+                sum += state->cityConnectionCost[c];
+                members++;
+            }
+        }
+        state->regionConnectionCost[m] = members > 0 ? sum / members : 0;
+    }
+}
+
+static void computeHubs(GameState* state) {
+    int n = state->nbCities;
+    int used[MAX_CITIES] = {0};
+    
+    state->nbHubs = 0;
+    while (state->nbHubs < MAX_HUBS && state->nbHubs < n) {
+        int best = -1;
+        for (int c = 0; c < n; c++) {
+            if (!used[c] && (best < 0 || state->cityBetweenness[c] > state->cityBetweenness[best])) {
+                best = c;
+            }
+        }
+        used[best] = 1;
+        state->hubCities[state->nbHubs++] = best;
+    }
+}
+
+static int validRoute(GameState* state, int r) {
+    return state->routes[r].from >= 0 && state->routes[r].from < state->nbCities &&
+           state->routes[r].to >= 0 && state->routes[r].to < state->nbCities;
+}
+
+// Compact per-city route lists
+static void buildIncidence(GameState* state) {
+    int n = state->nbCities;
+    int degree[MAX_CITIES + 1] = {0};
+    
+    for (int r = 0; r < state->nbTracks; r++) {
+        if (!validRoute(state, r)) continue;
+        degree[state->routes[r].from]++;
+        degree[state->routes[r].to]++;
+    }
+    
+    state->incidentStart[0] = 0;
+    for (int c = 0; c < n; c++) {
+        state->incidentStart[c + 1] = state->incidentStart[c] + degree[c];
+        degree[c] = state->incidentStart[c];
+    }
+    
+    for (int r = 0; r < state->nbTracks; r++) {
+        if (!validRoute(state, r)) continue;
+        state->incidentRoutes[degree[state->routes[r].from]++] = r;
+        state->incidentRoutes[degree[state->routes[r].to]++] = r;
+    }
+}
+
+void initTopology(GameState* state) {
+    if (!state || state->nbCities <= 0 || state->nbCities > MAX_CITIES) {
+        return;
+    }
+    
+    buildIncidence(state);
+    computeBetweenness(state);
+    computeConnectionCosts(state);
+    computeRegions(state);
+    computeHubs(state);
+}
+
+// City in a region noticeably more expensive to connect than the map average
+int isRemoteCity(GameState* state, int city) {
+    if (!state || city < 0 || city >= state->nbCities || state->nbRegions == 0) {
+        return 0;
+    }
+    
+    int region = state->cityRegion[city];
+    return state->regionConnectionCost[region] > state->mapConnectionCost * REMOTE_REGION_FACTOR;
+}
\ No newline at end of file
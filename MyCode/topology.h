@@ -0,0 +1,9 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+#include "gamestate.h"
+#include "../tickettorideapi/ticketToRide.h"
+
+void initTopology(GameState* state);
+int isRemoteCity(GameState* state, int city);
+
+#endif
\ No newline at end of file